@@ -0,0 +1,80 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include "src/BatchSolver.h"
+#include "src/MPITimer.h"
+#include "src/Random.h"
+
+#define TSP_N_MIGRATE 20                                // number of parents migrating left/right per migration round
+#define TSP_GENS_BETWEEN_MIGRATE 5                      // number of generations between migration
+#define TSP_N_KEEP_BEST_PARENTS 2                       // number of parents not reproducing, to keep optimal solution
+
+#define TSP_TIME_BUDGET 0.0                             // wall-clock time per instance in seconds (0: no time limit)
+#define TSP_STAGNATION_GENERATIONS 0                    // stop if no improvement for this many gens (0: off)
+
+int main(int argc, char** argv) {
+    /// check for the correct number of input parameters
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s pop_size gens file [file ...]\n", argv[0]);
+        fprintf(stderr, "    pop_size = number of trial populations for the genetic algorithm per instance\n");
+        fprintf(stderr, "    gens     = number of generations per instance, 0: until a termination criterion is met\n");
+        fprintf(stderr, "    file     = input file with one 'x,y' point per line\n");
+        exit(-1);
+    }
+
+    /// ----- get input parameters -----
+    char* pEnd;
+    TSPParameters params;
+    params.populationSize = strtol(argv[1], &pEnd, 10);
+    params.generations = strtol(argv[2], &pEnd, 10);
+    params.nMigrate = TSP_N_MIGRATE;
+    params.nKeepBestParents = TSP_N_KEEP_BEST_PARENTS;
+    params.generationsBetweenMigrate = TSP_GENS_BETWEEN_MIGRATE;
+    params.timeBudget = TSP_TIME_BUDGET;
+    params.stagnationGenerations = TSP_STAGNATION_GENERATIONS;
+
+    /// ----- initialize MPI and the random engine -----
+    int rc = MPI_Init(&argc, &argv);
+    if (rc != MPI_SUCCESS) {
+        printf("MPI initialization failed\n");
+        exit(-1);
+    }
+
+    int id;
+    MPI_Comm_rank(MPI_COMM_WORLD, &id);
+    Random::initialize(10 * id + (int) time(nullptr));
+
+    {
+        /// ----- load the instances on the root process and share them with all processes -----
+        std::vector<TSPInstance> instances(argc - 3);
+        for (unsigned long i = 0; i < instances.size(); i++) {
+            if (id == 0) instances[i] = TSPInstance::fromFile(argv[i + 3]);
+        }
+        TSPInstance::share(instances, MPI_COMM_WORLD);
+        for (unsigned long i = 0; i < instances.size(); i++) {
+            instances[i].name = argv[i + 3];
+        }
+
+        /// ----- solve all instances -----
+        MPITimer timer;
+        BatchSolver batchSolver(MPI_COMM_WORLD);
+
+        timer.start();
+        auto solutions = batchSolver.solveAll(instances, params);
+        timer.stop();
+
+        /// ----- print the route length of every instance -----
+        if (id == 0) {
+            for (unsigned long i = 0; i < solutions.size(); i++) {
+                printf("%s, %lu points, %lu generations, route length: %f\n", instances[i].name.c_str(),
+                       instances[i].nPoints, solutions[i].generations, solutions[i].routeLength);
+            }
+            timer.printTimeStats();
+        }
+    }
+
+    MPI_Finalize();
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include "src/DecompositionSolver.h"
+#include "src/MPITimer.h"
+#include "src/Random.h"
+
+#define TSP_N_MIGRATE 20                                // number of parents migrating left/right per migration round
+#define TSP_GENS_BETWEEN_MIGRATE 5                      // number of generations between migration
+#define TSP_N_KEEP_BEST_PARENTS 2                       // number of parents not reproducing, to keep optimal solution
+
+#define TSP_TIME_BUDGET 0.0                             // wall-clock time per cluster in seconds (0: no time limit)
+#define TSP_STAGNATION_GENERATIONS 0                    // stop if no improvement for this many gens (0: off)
+#define TSP_JOINT_WINDOW 25                             // points on either side of a joint between clusters to refine
+
+#define TSP_ROUTE_FILE_NAME "route.dat"                 // output file with the point indices of the route
+
+int main(int argc, char** argv) {
+    /// check for the correct number of input parameters
+    if (argc != 5) {
+        fprintf(stderr, "usage: %s pop_size gens cluster_size file\n", argv[0]);
+        fprintf(stderr, "    pop_size     = number of trial populations for the genetic algorithm per cluster\n");
+        fprintf(stderr, "    gens         = number of generations per cluster, 0: until termination criteria stop\n");
+        fprintf(stderr, "    cluster_size = maximum number of points per cluster\n");
+        fprintf(stderr, "    file         = input file with one 'x,y' point per line\n");
+        exit(-1);
+    }
+
+    /// ----- get input parameters -----
+    char* pEnd;
+    TSPParameters params;
+    params.populationSize = strtol(argv[1], &pEnd, 10);
+    params.generations = strtol(argv[2], &pEnd, 10);
+    params.clusterSize = strtol(argv[3], &pEnd, 10);
+    params.nMigrate = TSP_N_MIGRATE;
+    params.nKeepBestParents = TSP_N_KEEP_BEST_PARENTS;
+    params.generationsBetweenMigrate = TSP_GENS_BETWEEN_MIGRATE;
+    params.timeBudget = TSP_TIME_BUDGET;
+    params.stagnationGenerations = TSP_STAGNATION_GENERATIONS;
+    params.jointWindow = TSP_JOINT_WINDOW;
+
+    /// ----- initialize MPI and the random engine -----
+    int rc = MPI_Init(&argc, &argv);
+    if (rc != MPI_SUCCESS) {
+        printf("MPI initialization failed\n");
+        exit(-1);
+    }
+
+    int id;
+    MPI_Comm_rank(MPI_COMM_WORLD, &id);
+    Random::initialize(10 * id + (int) time(nullptr));
+
+    {
+        /// ----- load the instance on the root process and share it with all processes -----
+        TSPInstance instance;
+        if (id == 0) instance = TSPInstance::fromFile(argv[4]);
+        instance.share(MPI_COMM_WORLD);
+
+        /// ----- solve the instance and write the route -----
+        MPITimer timer;
+        DecompositionSolver decompositionSolver(MPI_COMM_WORLD);
+
+        timer.start();
+        auto solution = decompositionSolver.solve(instance, params);
+        decompositionSolver.writeRoute(TSP_ROUTE_FILE_NAME, solution);
+        timer.stop();
+
+        if (id == 0) {
+            printf("%s, %lu points, %lu clusters, route length: %f\n", argv[4], solution.nPoints,
+                   solution.nClusters, solution.routeLength);
+            timer.printTimeStats();
+        }
+    }
+
+    MPI_Finalize();
+
+    return 0;
+}
@@ -2,27 +2,53 @@
 // Created by thijs on 22-04-22.
 //
 
-#include "src/TravellingSalesman.h"
-#include "src/MPIController.h"
+#include <memory>
+
+#include "src/TSPSolver.h"
+#include "src/TSPOutputFile.h"
+#include "src/MetricsServer.h"
+#include "src/NUMAPlacement.h"
 #include "src/MPITimer.h"
 #include "src/Random.h"
 
 #define TSP_N_RUNS 10                                   // number of runs to average the time between
 #define TSP_USE_DEFAULT_SEED 0                          // use default seed to make points in every random run the same
 
-#define TSP_USE_FILE_INPUT_POINTS 1                     // use an input file with starting points
+#define TSP_USE_FILE_INPUT_POINTS 1                     // 0: random points, 1: input file with points, 2: matrix file
 #define TSP_FILE_NAME "../src/inputdata/uscapitals.dat" // file name containing input starting points
+#define TSP_METRIC MetricType::euclidean                // distance between points: euclidean, manhattan or geographic
+#define TSP_MATRIX_FILE_NAME "distances.bin"            // binary n_route x n_route distance matrix (row-major doubles)
+#define TSP_MATRIX_SYMMETRIC 1                          // 0: the matrix is asymmetric (e.g. travel times)
 
 #define TSP_N_MIGRATE 20                                // number of parents migrating left/right per migration round
 #define TSP_GENS_BETWEEN_MIGRATE 5                      // number of generations between migration
 #define TSP_N_KEEP_BEST_PARENTS 2                       // number of parents not reproducing, to keep optimal solution
+#define TSP_N_ISLANDS 1                                 // number of islands (sub-populations) per process
+#define TSP_N_ISLAND_MIGRATE 2                          // number of parents migrating left/right between islands
+#define TSP_GENS_BETWEEN_ISLAND_MIGRATE 5               // number of generations between migration between islands
+#define TSP_ADAPTIVE_MUTATION 1                         // 0: mutate by a random swap, 1: choose operators by bandit
+#define TSP_STEADY_STATE 0                              // replace the worst parents by better offspring in place
+#define TSP_N_OFFSPRING 16                              // number of offspring per generation in steady state mode
+#define TSP_BALANCE_POPULATION 0                        // move parents to processes that breed faster
+#define TSP_GENS_BETWEEN_BALANCE 50                     // number of generations between balancing rounds
+
+#define TSP_TIME_BUDGET 0.0                             // wall-clock time per run in seconds (0: no time limit)
+#define TSP_TARGET_LENGTH 0.0                           // stop once a route of at most this length is found (0: off)
+#define TSP_STAGNATION_GENERATIONS 0                    // stop if no process improved for this many gens (0: off)
+#define TSP_BOUND_ITERATIONS 0                          // subgradient iterations for the lower bound (0: no bound)
+#define TSP_TARGET_GAP 0.0                              // stop once within this fraction of the lower bound (0: off)
+
+#define TSP_NUMA_PLACEMENT 0                            // pin every process to cores of one NUMA node
+
+#define TSP_METRICS_INTERVAL 0                          // generations between updating the metrics endpoint (0: off)
+#define TSP_METRICS_ADDRESS "9464"                      // localhost TCP port or Unix socket path of the endpoint
 
 int main(int argc, char** argv) {
     /// check for the correct number of input parameters
     if (argc < 5 || argc > 7) {
-        fprintf(stderr, "usage: %s pop_size n_route x_size [y_size] [cout]\n", argv[0]);
+        fprintf(stderr, "usage: %s pop_size gens n_route x_size [y_size] [cout]\n", argv[0]);
         fprintf(stderr, "    pop_size = number of trial populations for the genetic algorithm\n");
-        fprintf(stderr, "    gens     = number of generations (\'time steps\')\n");
+        fprintf(stderr, "    gens     = number of generations (\'time steps\'), 0: until a termination criterion is met\n");
         fprintf(stderr, "    n_route  = number of points for the salesman to travel past\n");
         fprintf(stderr, "    x_size   = box width where the route points could be in\n");
         fprintf(stderr, "    y_size   = (optional) box height -- default: x_size\n");
@@ -30,42 +56,139 @@ int main(int argc, char** argv) {
         exit(-1);
     }
 
-    /// ----- initialize program variables -----
-    auto mpiController = MPIController(argc, argv, TSP_N_MIGRATE);
-    auto travellingSalesman = TravellingSalesman(argc, argv, &mpiController,
-                                                 TSP_N_KEEP_BEST_PARENTS, TSP_GENS_BETWEEN_MIGRATE);
+    /// ----- get input parameters -----
+    char* pEnd;
+    TSPParameters params;
+    params.populationSize = strtol(argv[1], &pEnd, 10);
+    params.generations = strtol(argv[2], &pEnd, 10);
+    unsigned long nPoints = strtol(argv[3], &pEnd, 10);
+    double xSize = strtod(argv[4], &pEnd);
+    double ySize = argc > 5 ? strtod(argv[5], &pEnd) : xSize;
+    params.cout = argc > 6 ? strtol(argv[6], &pEnd, 10) : 0;
+
+    params.nMigrate = TSP_N_MIGRATE;
+    params.nKeepBestParents = TSP_N_KEEP_BEST_PARENTS;
+    params.generationsBetweenMigrate = TSP_GENS_BETWEEN_MIGRATE;
+    params.nIslands = TSP_N_ISLANDS;
+    params.nIslandMigrate = TSP_N_ISLAND_MIGRATE;
+    params.generationsBetweenIslandMigrate = TSP_GENS_BETWEEN_ISLAND_MIGRATE;
+    params.adaptiveMutation = TSP_ADAPTIVE_MUTATION;
+    params.steadyState = TSP_STEADY_STATE;
+    params.nOffspring = TSP_N_OFFSPRING;
+    params.balancePopulation = TSP_BALANCE_POPULATION;
+    params.generationsBetweenBalance = TSP_GENS_BETWEEN_BALANCE;
+    params.timeBudget = TSP_TIME_BUDGET;
+    params.targetLength = TSP_TARGET_LENGTH;
+    params.stagnationGenerations = TSP_STAGNATION_GENERATIONS;
+    params.boundIterations = TSP_BOUND_ITERATIONS;
+    params.targetGap = TSP_TARGET_GAP;
+    params.metricsInterval = TSP_METRICS_INTERVAL;
+
+    if (xSize < 0.1 || xSize >= 10000.0) {
+        std::cerr << "x_size should be between 0.1 and 10000" << std::endl;
+        exit(-1);
+    }
+    if (ySize < 0.1 || ySize >= 10000.0) {
+        std::cerr << "y_size should be between 0.1 and 10000" << std::endl;
+        exit(-1);
+    }
+
+    /// ----- initialize MPI, only the main thread makes MPI calls (the metrics server does not) -----
+    int provided;
+    int rc = MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    if (rc != MPI_SUCCESS || provided < MPI_THREAD_FUNNELED) {
+        printf("MPI initialization failed\n");
+        exit(-1);
+    }
+
+    int id, pnLength;
+    char pName[MPI_MAX_PROCESSOR_NAME]{};
+    MPI_Comm_rank(MPI_COMM_WORLD, &id);
+    MPI_Get_processor_name(pName, &pnLength);
+
+    if (id == 0) {
+        printf("MPI initialized\n");
+    }
+
+    {
+        /// ----- pin the processes before allocating the populations, so their memory is on the local node -----
+        NUMAPlacement placement(MPI_COMM_WORLD);
+#if TSP_NUMA_PLACEMENT == 1
+        placement.pin();
+#endif
+
+        /// ----- initialize the solver and the output file on the root process -----
+        TSPSolver solver(MPI_COMM_WORLD);
+        std::unique_ptr<TSPOutputFile> outputFile;
+        if (params.cout > 0 && id == 0) {
+            outputFile = std::make_unique<TSPOutputFile>("tsp.dat", params.cout);
+            solver.setBestPathCallback([&outputFile, &solver](unsigned long generation, double routeLength,
+                                                              const std::vector<unsigned long> &order) {
+                outputFile->printPath(generation, routeLength, order, solver.getLowerBound());
+            });
+        }
+
+        /// ----- serve the metrics from a background thread on the root process -----
+        std::unique_ptr<MetricsServer> metricsServer;
+        std::string instanceName;
+        if (params.metricsInterval > 0 && id == 0) {
+            metricsServer = std::make_unique<MetricsServer>(TSP_METRICS_ADDRESS);
+            solver.setMetricsCallback([&metricsServer, &instanceName](const TSPMetrics &metrics) {
+                metricsServer->update(metrics, instanceName);
+            });
+        }
 
-    /// ----- initialize the timer and random engine
-    MPITimer timer;
+        /// ----- initialize the timer and random engine
+        MPITimer timer;
 #if TSP_USE_DEFAULT_SEED == 0
-    Random::initialize(10 * mpiController.getID() + (int) time(nullptr));
+        Random::initialize(10 * id + (int) time(nullptr));
 #else
-    Random::initialize(mpiController.getID() + 12345);
+        Random::initialize(id + 12345);
 #endif
 
-    /// ----- run TSP_N_RUNS times to measure mean and std of time taken -----
-    for (int n = 0; n < TSP_N_RUNS; n++) {
-        timer.start();
+        /// ----- run TSP_N_RUNS times to measure mean and std of time taken -----
+        placement.startCounters();
+        for (int n = 0; n < TSP_N_RUNS; n++) {
+            timer.start();
 
-        /// ----- create a population of paths -----
+            /// ----- create the points on the root process and share them with all processes -----
+            TSPInstance instance;
+            if (id == 0) {
 #if TSP_USE_FILE_INPUT_POINTS == 0
-        travellingSalesman.randomizeRoutePoints();
+                instance = TSPInstance::random(nPoints, xSize, ySize);
+                instance.metric = TSP_METRIC;
+#elif TSP_USE_FILE_INPUT_POINTS == 1
+                instance = TSPInstance::fromFile(TSP_FILE_NAME, nPoints);
+                instance.metric = TSP_METRIC;
 #else
-        travellingSalesman.loadRoutePoints(TSP_FILE_NAME);
+                instance = TSPInstance::fromMatrixFile(TSP_MATRIX_FILE_NAME, TSP_MATRIX_SYMMETRIC);
+                if (instance.nPoints != nPoints) {
+                    std::cerr << TSP_MATRIX_FILE_NAME << " is a " << instance.nPoints << " x " << instance.nPoints
+                              << " matrix, expected n_route = " << nPoints << std::endl;
+                    exit(-1);
+                }
 #endif
+                if (outputFile) outputFile->printPoints(params.populationSize, params.generations, instance);
+            }
+            instance.share(MPI_COMM_WORLD);
+            if (id == 0) instanceName = instance.name;
 
-        travellingSalesman.createPopulation();
+            /// ----- solve the instance -----
+            auto solution = solver.solve(instance, params);
+            if (id == 0 && solution.lowerBound > 0.0) {
+                printf("route length: %f, lower bound: %f, gap: %.3f%%\n", solution.routeLength, solution.lowerBound,
+                       100.0 * (solution.routeLength - solution.lowerBound) / solution.lowerBound);
+            }
 
-        /// ----- create new generations of paths in a loop -----
-        for (unsigned long generation = 0; generation < travellingSalesman.getNumberOfGenerations(); generation++) {
-            travellingSalesman.runGeneration(generation);
+            timer.stop();
         }
-        timer.stop();
+        timer.printTimeStats();
+        placement.printCounters();
     }
-    timer.printTimeStats();
 
-    /// ----- finalize mpi, close file and exit -----
-    mpiController.finalize();
+    /// ----- finalize mpi and exit -----
+    printf("\nhost %s (%d)\n", pName, id);
+    MPI_Finalize();
 
     return 0;
 }
@@ -16,8 +16,18 @@ def ReadPoints(filename, length):
     data = np.loadtxt(filename, skiprows=4, max_rows=length + 1)
     return data
 
-def ReadPath(filename, length, generations):
-    data = np.loadtxt(filename, skiprows=length + 7, delimiter=',', max_rows=generations)
+def ReadPath(filename, length):
+    # the file holds a block per run, the paths of the first run end at a blank line or the header of the next run
+    # (the number of generations is 0 if the run was stopped by a termination criterion, so it can't be used)
+    lines = []
+    with open(filename) as file:
+        for i, line in enumerate(file):
+            if i < length + 7:
+                continue
+            if not line.strip() or "population size" in line:
+                break
+            lines.append(line)
+    data = np.loadtxt(lines, delimiter=',', ndmin=2)
     return data
 
 populationSize, generations, length, xSize, ySize = ReadHeader("./build/tsp.dat")
@@ -25,7 +35,7 @@ print(length)
 points = ReadPoints("./build/tsp.dat", length)
 xPoints = points[:, 0]
 yPoints = points[:, 1]
-data = ReadPath("./build/tsp.dat", length, generations)
+data = ReadPath("./build/tsp.dat", length)
 
 generation = data[:, 0]
 pathLength = data[:, 1]
@@ -0,0 +1,139 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include "src/FrameRenderer.h"
+#include "src/TSPLogReader.h"
+
+#define TSP_FIGURE_DIRECTORY "figures"                  // output directory of the frames tsp0000, tsp0001, ...
+#define TSP_DEFAULT_IMAGE_SIZE 800                      // width and height of the frames in pixels
+#define TSP_QUEUED_FRAMES_PER_THREAD 4                  // number of paths read ahead per render thread
+
+struct Frame {
+    unsigned long generation = 0;
+    double routeLength = 0.0;
+    std::vector<unsigned long> order;
+};
+
+int main(int argc, char** argv) {
+    /// check for the correct number of input parameters
+    if (argc < 2 || argc > 7) {
+        fprintf(stderr, "usage: %s file [format] [every] [image_size] [threads] [run]\n", argv[0]);
+        fprintf(stderr, "    file       = run log written by GATSP (tsp.dat)\n");
+        fprintf(stderr, "    format     = (optional) png or svg -- default: png\n");
+        fprintf(stderr, "    every      = (optional) render every n-th improving path -- default: 1\n");
+        fprintf(stderr, "    image_size = (optional) width and height in pixels -- default: %d\n",
+                TSP_DEFAULT_IMAGE_SIZE);
+        fprintf(stderr, "    threads    = (optional) number of render threads -- default: number of cores\n");
+        fprintf(stderr, "    run        = (optional) run of the log to render, counted from 1 -- default: 1\n");
+        exit(-1);
+    }
+
+    /// ----- get input parameters -----
+    std::string format = argc > 2 ? argv[2] : "png";
+    unsigned long every = argc > 3 ? strtoul(argv[3], nullptr, 10) : 1;
+    unsigned long imageSize = argc > 4 ? strtoul(argv[4], nullptr, 10) : TSP_DEFAULT_IMAGE_SIZE;
+    unsigned long nThreads = argc > 5 ? strtoul(argv[5], nullptr, 10) : std::thread::hardware_concurrency();
+    nThreads = std::max(nThreads, 1ul);
+    unsigned long run = argc > 6 ? strtoul(argv[6], nullptr, 10) : 1;
+
+    if (format != "png" && format != "svg") {
+        fprintf(stderr, "format should be png or svg\n");
+        exit(-1);
+    }
+    if (every < 1) {
+        fprintf(stderr, "every should be at least 1\n");
+        exit(-1);
+    }
+    if (imageSize < 16 || imageSize > 16384) {
+        fprintf(stderr, "image_size should be between 16 and 16384\n");
+        exit(-1);
+    }
+    if (run < 1) {
+        fprintf(stderr, "run should be at least 1\n");
+        exit(-1);
+    }
+    FrameFormat frameFormat = format == "png" ? FrameFormat::png : FrameFormat::svg;
+
+    TSPLogReader reader;
+    if (!reader.open(argv[1], run)) exit(-1);
+    FrameRenderer renderer(reader.getXPoints(), reader.getYPoints(), imageSize);
+    std::filesystem::create_directories(TSP_FIGURE_DIRECTORY);
+
+    /// ----- render the frames from a bounded queue in multiple threads -----
+    std::deque<std::pair<unsigned long, Frame>> queue;
+    std::mutex mutex;
+    std::condition_variable queueChanged;
+    bool finished = false;
+    unsigned long maxQueued = TSP_QUEUED_FRAMES_PER_THREAD * nThreads;
+
+    std::vector<std::thread> threads;
+    for (unsigned long t = 0; t < nThreads; t++) {
+        threads.emplace_back([&] {
+            while (true) {
+                std::pair<unsigned long, Frame> frame;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    queueChanged.wait(lock, [&] { return !queue.empty() || finished; });
+                    if (queue.empty()) return;
+                    frame = std::move(queue.front());
+                    queue.pop_front();
+                }
+                queueChanged.notify_all();
+
+                char fileName[64];
+                snprintf(fileName, sizeof(fileName), "%s/tsp%04lu.%s", TSP_FIGURE_DIRECTORY, frame.first,
+                         format.c_str());
+                renderer.render(frameFormat, frame.second.generation, frame.second.routeLength, frame.second.order,
+                                fileName);
+            }
+        });
+    }
+
+    unsigned long nFrames = 0;
+    auto addFrame = [&](Frame &frame) {
+        std::unique_lock<std::mutex> lock(mutex);
+        queueChanged.wait(lock, [&] { return queue.size() < maxQueued; });
+        queue.emplace_back(nFrames++, std::move(frame));
+        lock.unlock();
+        queueChanged.notify_all();
+    };
+
+    /// ----- stream the paths, rendering every 'every'-th improving path and the best path -----
+    Frame frame, skippedFrame;
+    bool isSkipped = false;
+    double bestRouteLength = std::numeric_limits<double>::max();
+    unsigned long nImproving = 0;
+    while (reader.readPath(frame.generation, frame.routeLength, frame.order)) {
+        if (!(frame.routeLength < bestRouteLength)) continue;
+        bestRouteLength = frame.routeLength;
+
+        if (nImproving++ % every == 0) {
+            addFrame(frame);
+            isSkipped = false;
+        } else {
+            std::swap(frame, skippedFrame);
+            isSkipped = true;
+        }
+    }
+    if (isSkipped) addFrame(skippedFrame);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    queueChanged.notify_all();
+    for (auto &thread : threads) thread.join();
+
+    printf("%lu of %lu improving paths rendered to %s\n", nFrames, nImproving, TSP_FIGURE_DIRECTORY);
+    if (reader.hasInvalidPath()) exit(-1);
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <algorithm>
+#include <numeric>
+
+#include "BatchSolver.h"
+
+BatchSolver::BatchSolver(MPI_Comm comm_) : comm(comm_), solver(MPI_COMM_SELF) {
+    MPI_Comm_rank(comm, &id);
+    MPI_Comm_size(comm, &nTasks);
+}
+
+std::vector<TSPSolution> BatchSolver::solveAll(const std::vector<TSPInstance> &instances,
+                                               const TSPParameters &params) {
+    unsigned long nInstances = instances.size();
+
+    /// order the queue from large to small instances
+    std::vector<unsigned long> queue(nInstances);
+    std::iota(queue.begin(), queue.end(), 0);
+    std::stable_sort(queue.begin(), queue.end(), [&instances](unsigned long a, unsigned long b) {
+        return instances[a].nPoints > instances[b].nPoints;
+    });
+
+    /// create the shared queue counter on the root process
+    long* counter = nullptr;
+    MPI_Win window;
+    MPI_Win_allocate(id == 0 ? (MPI_Aint) sizeof(long) : 0, sizeof(long), MPI_INFO_NULL, comm, &counter, &window);
+    if (id == 0) {
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, window);
+        *counter = 0;
+        MPI_Win_unlock(0, window);
+    }
+    MPI_Barrier(comm);
+
+    /// take instances from the queue until it is empty
+    std::vector<long> solvedIndices;
+    std::vector<double> solvedLengths;
+    std::vector<unsigned long> solvedGenerations;
+    std::vector<unsigned long> solvedOrders;
+
+    const long one = 1;
+    while (true) {
+        long next;
+        MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, window);
+        MPI_Fetch_and_op(&one, &next, MPI_LONG, 0, 0, MPI_SUM, window);
+        MPI_Win_unlock(0, window);
+        if (next >= (long) nInstances) break;
+
+        unsigned long index = queue[next];
+        TSPSolution solution = solver.solve(instances[index], params);
+
+        solvedIndices.push_back((long) index);
+        solvedLengths.push_back(solution.routeLength);
+        solvedGenerations.push_back(solution.generations);
+        solvedOrders.insert(solvedOrders.end(), solution.order.begin(), solution.order.end());
+    }
+
+    MPI_Win_free(&window);
+
+    /// gather the solutions of all processes to the root process
+    int nSolved = (int) solvedIndices.size();
+    int nSolvedPoints = (int) solvedOrders.size();
+    std::vector<int> allNSolved(nTasks), allNSolvedPoints(nTasks);
+    MPI_Gather(&nSolved, 1, MPI_INT, allNSolved.data(), 1, MPI_INT, 0, comm);
+    MPI_Gather(&nSolvedPoints, 1, MPI_INT, allNSolvedPoints.data(), 1, MPI_INT, 0, comm);
+
+    std::vector<int> displacements(nTasks, 0), pointDisplacements(nTasks, 0);
+    for (int i = 1; i < nTasks; i++) {
+        displacements[i] = displacements[i - 1] + allNSolved[i - 1];
+        pointDisplacements[i] = pointDisplacements[i - 1] + allNSolvedPoints[i - 1];
+    }
+
+    std::vector<long> allIndices(id == 0 ? nInstances : 0);
+    std::vector<double> allLengths(id == 0 ? nInstances : 0);
+    std::vector<unsigned long> allGenerations(id == 0 ? nInstances : 0);
+    std::vector<unsigned long> allOrders(id == 0 ? pointDisplacements[nTasks - 1] + allNSolvedPoints[nTasks - 1] : 0);
+
+    MPI_Gatherv(solvedIndices.data(), nSolved, MPI_LONG,
+                allIndices.data(), allNSolved.data(), displacements.data(), MPI_LONG, 0, comm);
+    MPI_Gatherv(solvedLengths.data(), nSolved, MPI_DOUBLE,
+                allLengths.data(), allNSolved.data(), displacements.data(), MPI_DOUBLE, 0, comm);
+    MPI_Gatherv(solvedGenerations.data(), nSolved, MPI_UNSIGNED_LONG,
+                allGenerations.data(), allNSolved.data(), displacements.data(), MPI_UNSIGNED_LONG, 0, comm);
+    MPI_Gatherv(solvedOrders.data(), nSolvedPoints, MPI_UNSIGNED_LONG,
+                allOrders.data(), allNSolvedPoints.data(), pointDisplacements.data(), MPI_UNSIGNED_LONG, 0, comm);
+
+    if (id != 0) return {};
+
+    /// put the solutions back in the order of the instances
+    std::vector<TSPSolution> solutions(nInstances);
+    unsigned long pointOffset = 0;
+    for (unsigned long i = 0; i < nInstances; i++) {
+        unsigned long index = allIndices[i];
+        unsigned long n = instances[index].nPoints;
+        solutions[index].routeLength = allLengths[i];
+        solutions[index].generations = allGenerations[i];
+        solutions[index].order.assign(&allOrders[pointOffset], &allOrders[pointOffset + n]);
+        pointOffset += n;
+    }
+
+    return solutions;
+}
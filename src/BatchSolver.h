@@ -0,0 +1,40 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_BATCHSOLVER_H
+#define GATSP_BATCHSOLVER_H
+
+
+#include <mpi.h>
+#include <vector>
+
+#include "TSPSolver.h"
+
+/**
+ * @brief solve a queue of independent instances, every process solving whole instances on its own
+ *
+ * Instances are handed out one at a time through a shared counter on the root process (MPI_Fetch_and_op), so fast
+ * processes take more instances than slow ones. The queue is ordered from large to small instances, which balances
+ * the tail of the batch and lets every process reuse its population for instances of similar size.
+ */
+class BatchSolver {
+private:
+    MPI_Comm comm;
+    int id, nTasks;
+    TSPSolver solver;
+
+public:
+    explicit BatchSolver(MPI_Comm comm_ = MPI_COMM_WORLD);
+
+    /**
+     * @brief solve all instances, return the solutions in the order of the instances on the root process
+     * (other processes return an empty vector)
+     *
+     * All processes pass the same instances and parameters, the population size is used per instance.
+     */
+    std::vector<TSPSolution> solveAll(const std::vector<TSPInstance> &instances, const TSPParameters &params);
+};
+
+
+#endif //GATSP_BATCHSOLVER_H
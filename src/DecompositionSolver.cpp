@@ -0,0 +1,380 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "DecompositionSolver.h"
+
+#define TSP_JOINT_TAG 61                                // tag of the messages refining the joints between processes
+#define TSP_REFINE_EPSILON 1e-9                         // minimum improvement of a 2-opt or Or-opt move
+
+DecompositionSolver::DecompositionSolver(MPI_Comm comm_)
+        : comm(comm_), clusterSolver(MPI_COMM_SELF), centroidSolver(comm_) {
+    MPI_Comm_rank(comm, &id);
+    MPI_Comm_size(comm, &nTasks);
+}
+
+DecompositionSolution DecompositionSolver::solve(const TSPInstance &instance, const TSPParameters &params) {
+    if (instance.matrix != nullptr) {
+        std::cerr << "the decomposition solver needs the coordinates of the points, not a distance matrix" << std::endl;
+        exit(-1);
+    }
+    if (params.clusterSize < 8) {
+        std::cerr << "cluster size should be at least 8" << std::endl;
+        exit(-1);
+    }
+
+    DecompositionSolution solution;
+    withMetric(instance.metric, instance.xPoints, instance.yPoints, instance.matrix, instance.nPoints,
+               [this, &instance, &params, &solution](const auto &metric) {
+                   if constexpr (std::remove_reference_t<decltype(metric)>::symmetric) {
+                       solution = solve(instance, params, metric);
+                   }
+               });
+
+    return solution;
+}
+
+template<class Metric>
+DecompositionSolution DecompositionSolver::solve(const TSPInstance &instance, const TSPParameters &params,
+                                                 const Metric &metric) {
+    /// ----- divide the points into clusters and order them by a route over their centroids -----
+    setClusters(instance, params.clusterSize);
+    setClusterOrder(instance, params);
+    setJoints(instance, metric);
+
+    routeStart.assign(nClusters + 1, 0);
+    for (unsigned long p = 0; p < nClusters; p++) {
+        unsigned long cluster = clusterOrder[p];
+        routeStart[p + 1] = routeStart[p] + clusterStart[cluster + 1] - clusterStart[cluster];
+    }
+
+    /// ----- solve and refine the clusters of this process and stitch their paths -----
+    DecompositionSolution solution;
+    solution.nPoints = nPoints;
+    solution.nClusters = nClusters;
+
+    unsigned long first = getFirstPosition(id);
+    unsigned long last = getFirstPosition(id + 1);
+    solution.offset = routeStart[first];
+    auto &order = solution.order;
+    order.reserve(routeStart[last] - routeStart[first]);
+
+    TSPParameters clusterParams = params;
+    clusterParams.boundIterations = 0;
+    clusterParams.cout = 0;
+    for (unsigned long p = first; p < last; p++) {
+        auto path = solveCluster(instance, clusterParams, p, metric);
+        refinePath(path.data(), path.size(), metric);
+        order.insert(order.end(), path.begin(), path.end());
+    }
+
+    /// ----- refine the joints between the clusters of this process, then between the processes -----
+    for (unsigned long p = first + 1; p < last; p++) {
+        unsigned long joint = routeStart[p] - solution.offset;
+        unsigned long begin = joint > params.jointWindow ? joint - params.jointWindow : 0;
+        unsigned long end = std::min(joint + params.jointWindow, order.size());
+        refinePath(&order[begin], end - begin, metric);
+    }
+    refineProcessJoints(order, params.jointWindow, metric);
+
+    /// ----- sum the length of the route, including the edge to the first point of the next process -----
+    double routeLength = 0.0;
+    if (!order.empty()) {
+        for (unsigned long i = 1; i < order.size(); i++) {
+            routeLength += metric(order[i - 1], order[i]);
+        }
+
+        unsigned long nextPoint;
+        MPI_Sendrecv(&order[0], 1, MPI_UNSIGNED_LONG, getNextProcess(id, -1), TSP_JOINT_TAG,
+                     &nextPoint, 1, MPI_UNSIGNED_LONG, getNextProcess(id, 1), TSP_JOINT_TAG, comm,
+                     MPI_STATUS_IGNORE);
+        routeLength += metric(order.back(), nextPoint);
+    }
+    MPI_Allreduce(&routeLength, &solution.routeLength, 1, MPI_DOUBLE, MPI_SUM, comm);
+
+    return solution;
+}
+
+void DecompositionSolver::setClusters(const TSPInstance &instance, unsigned long clusterSize) {
+    nPoints = instance.nPoints;
+    pointIndex.resize(nPoints);
+    std::iota(pointIndex.begin(), pointIndex.end(), 0);
+    clusterStart.clear();
+
+    /// bisect ranges of points at the median of their widest coordinate until they are small enough, the ranges are
+    /// processed depth-first from the left so the clusters are found in order of their start
+    std::vector<std::pair<unsigned long, unsigned long>> ranges = {{0, nPoints}};
+    while (!ranges.empty()) {
+        auto [begin, end] = ranges.back();
+        ranges.pop_back();
+        if (end - begin <= clusterSize) {
+            clusterStart.push_back(begin);
+            continue;
+        }
+
+        auto xRange = std::minmax_element(&pointIndex[begin], &pointIndex[0] + end, [&instance](auto a, auto b) {
+            return instance.xPoints[a] < instance.xPoints[b];
+        });
+        auto yRange = std::minmax_element(&pointIndex[begin], &pointIndex[0] + end, [&instance](auto a, auto b) {
+            return instance.yPoints[a] < instance.yPoints[b];
+        });
+        double xWidth = instance.xPoints[*xRange.second] - instance.xPoints[*xRange.first];
+        double yWidth = instance.yPoints[*yRange.second] - instance.yPoints[*yRange.first];
+        const double* points = xWidth >= yWidth ? instance.xPoints : instance.yPoints;
+
+        unsigned long middle = begin + (end - begin) / 2;
+        std::nth_element(&pointIndex[begin], &pointIndex[middle], &pointIndex[0] + end, [points](auto a, auto b) {
+            return points[a] < points[b];
+        });
+        ranges.emplace_back(middle, end);
+        ranges.emplace_back(begin, middle);
+    }
+    nClusters = clusterStart.size();
+    clusterStart.push_back(nPoints);
+
+    xCentroids.assign(nClusters, 0.0);
+    yCentroids.assign(nClusters, 0.0);
+    for (unsigned long c = 0; c < nClusters; c++) {
+        for (unsigned long i = clusterStart[c]; i < clusterStart[c + 1]; i++) {
+            xCentroids[c] += instance.xPoints[pointIndex[i]];
+            yCentroids[c] += instance.yPoints[pointIndex[i]];
+        }
+        xCentroids[c] /= (double) (clusterStart[c + 1] - clusterStart[c]);
+        yCentroids[c] /= (double) (clusterStart[c + 1] - clusterStart[c]);
+    }
+}
+
+void DecompositionSolver::setClusterOrder(const TSPInstance &instance, const TSPParameters &params) {
+    /// the genetic algorithm needs at least 4 points
+    if (nClusters < 4) {
+        clusterOrder.resize(nClusters);
+        std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+        return;
+    }
+
+    TSPInstance centroids = TSPInstance::fromPoints(xCentroids, yCentroids);
+    centroids.metric = instance.metric;
+
+    TSPParameters centroidParams = params;
+    centroidParams.boundIterations = 0;
+    centroidParams.cout = 0;
+    clusterOrder = centroidSolver.solve(centroids, centroidParams).order;
+}
+
+template<class Metric>
+void DecompositionSolver::setJoints(const TSPInstance &instance, const Metric &metric) {
+    entryPoints.resize(nClusters);
+    exitPoints.resize(nClusters);
+
+    /// return the point of the cluster closest to (x, y), other than the excluded point
+    auto getClosestPoint = [this, &instance](unsigned long cluster, double x, double y, unsigned long excluded) {
+        unsigned long closest = pointIndex[clusterStart[cluster]];
+        double closestDistance = std::numeric_limits<double>::max();
+        for (unsigned long i = clusterStart[cluster]; i < clusterStart[cluster + 1]; i++) {
+            unsigned long point = pointIndex[i];
+            double dx = instance.xPoints[point] - x;
+            double dy = instance.yPoints[point] - y;
+            if (point != excluded && dx * dx + dy * dy < closestDistance) {
+                closest = point;
+                closestDistance = dx * dx + dy * dy;
+            }
+        }
+        return closest;
+    };
+
+    /// the route enters the first cluster at its point closest to the centroid of the last cluster
+    unsigned long lastCluster = clusterOrder[nClusters - 1];
+    entryPoints[0] = getClosestPoint(clusterOrder[0], xCentroids[lastCluster], yCentroids[lastCluster], nPoints);
+
+    for (unsigned long p = 0; p < nClusters; p++) {
+        unsigned long cluster = clusterOrder[p];
+        unsigned long nextCluster = clusterOrder[(p + 1) % nClusters];
+
+        /// leave the cluster at its point closest to the centroid of the next cluster, which is not the entry point
+        unsigned long excluded = clusterStart[cluster + 1] - clusterStart[cluster] > 1 ? entryPoints[p] : nPoints;
+        exitPoints[p] = getClosestPoint(cluster, xCentroids[nextCluster], yCentroids[nextCluster], excluded);
+        if (p + 1 == nClusters) break;
+
+        /// enter the next cluster at its point closest to the exit point
+        double closestDistance = std::numeric_limits<double>::max();
+        for (unsigned long i = clusterStart[nextCluster]; i < clusterStart[nextCluster + 1]; i++) {
+            double distance = metric.compare(exitPoints[p], pointIndex[i]);
+            if (distance < closestDistance) {
+                entryPoints[p + 1] = pointIndex[i];
+                closestDistance = distance;
+            }
+        }
+    }
+}
+
+unsigned long DecompositionSolver::getFirstPosition(int process) const {
+    /// every process gets the positions of the route over the clusters which start in its share of the points
+    return std::lower_bound(routeStart.begin(), routeStart.end() - 1, (unsigned long) process,
+                            [this](unsigned long start, unsigned long value) {
+                                return start * nTasks < value * nPoints;
+                            }) - routeStart.begin();
+}
+
+int DecompositionSolver::getNextProcess(int process, int step) const {
+    /// skip the processes without clusters
+    int next = process;
+    do {
+        next = (next + step + nTasks) % nTasks;
+    } while (getFirstPosition(next) == getFirstPosition(next + 1));
+
+    return next;
+}
+
+template<class Metric>
+std::vector<unsigned long> DecompositionSolver::solveCluster(const TSPInstance &instance,
+                                                             const TSPParameters &params,
+                                                             unsigned long position, const Metric &metric) {
+    unsigned long cluster = clusterOrder[position];
+    std::vector<unsigned long> points(&pointIndex[clusterStart[cluster]], &pointIndex[0] + clusterStart[cluster + 1]);
+    unsigned long clusterSize = points.size();
+
+    /// solve the cluster as a closed route, the genetic algorithm needs at least 4 points
+    std::vector<unsigned long> route = points;
+    if (clusterSize >= 4) {
+        auto solution = clusterSolver.solve(instance.subset(points), params);
+        for (unsigned long i = 0; i < clusterSize; i++) route[i] = points[solution.order[i]];
+    }
+
+    std::rotate(route.begin(), std::find(route.begin(), route.end(), entryPoints[position]), route.end());
+    if (clusterSize == 1) return route;
+
+    /// cut the route r into a path from the entry point r[0] to the exit point r[j] by replacing two of its edges,
+    /// which gives either r[0], r[m-1], ..., r[j+1], r[1], ..., r[j] or r[0], r[1], ..., r[j-1], r[m-1], ..., r[j]
+    unsigned long j = std::find(route.begin(), route.end(), exitPoints[position]) - route.begin();
+    unsigned long m = clusterSize;
+    if (j == m - 1) return route;
+    if (j == 1) {
+        std::reverse(route.begin() + 1, route.end());
+        return route;
+    }
+
+    double costFront = metric(route[j + 1], route[1]) - metric(route[0], route[1]) - metric(route[j], route[j + 1]);
+    double costBack = metric(route[j - 1], route[m - 1]) - metric(route[j - 1], route[j]) -
+                      metric(route[m - 1], route[0]);
+    if (costFront < costBack) {
+        std::reverse(route.begin() + (long) j + 1, route.end());
+        std::rotate(route.begin() + 1, route.begin() + (long) j + 1, route.end());
+    } else {
+        std::reverse(route.begin() + (long) j, route.end());
+    }
+
+    return route;
+}
+
+template<class Metric>
+void DecompositionSolver::refineProcessJoints(std::vector<unsigned long> &order, unsigned long jointWindow,
+                                              const Metric &metric) {
+    if (order.empty()) return;
+
+    /// the windows at the start and end of the route part of a process do not overlap
+    int previous = getNextProcess(id, -1);
+    int next = getNextProcess(id, 1);
+    unsigned long previousSize = routeStart[getFirstPosition(previous + 1)] - routeStart[getFirstPosition(previous)];
+    unsigned long window = std::min(jointWindow, order.size() / 2);
+    unsigned long previousWindow = std::min(jointWindow, previousSize / 2);
+
+    /// receive the end of the previous process, and refine it together with the start of this process
+    std::vector<unsigned long> path(previousWindow + window);
+    MPI_Sendrecv(order.data() + order.size() - window, (int) window, MPI_UNSIGNED_LONG, next, TSP_JOINT_TAG,
+                 path.data(), (int) previousWindow, MPI_UNSIGNED_LONG, previous, TSP_JOINT_TAG, comm,
+                 MPI_STATUS_IGNORE);
+    std::copy(order.begin(), order.begin() + (long) window, path.begin() + (long) previousWindow);
+    refinePath(path.data(), path.size(), metric);
+    std::copy(path.begin() + (long) previousWindow, path.end(), order.begin());
+
+    /// return the refined end to the previous process
+    MPI_Sendrecv(path.data(), (int) previousWindow, MPI_UNSIGNED_LONG, previous, TSP_JOINT_TAG,
+                 order.data() + order.size() - window, (int) window, MPI_UNSIGNED_LONG, next, TSP_JOINT_TAG, comm,
+                 MPI_STATUS_IGNORE);
+}
+
+template<class Metric>
+void DecompositionSolver::refinePath(unsigned long* path, unsigned long pathSize, const Metric &metric) {
+    if (pathSize < 4) return;
+
+    bool improved = true;
+    while (improved) {
+        improved = false;
+
+        /// 2-opt: reverse path[i+1] to path[j] if that shortens the path
+        for (unsigned long i = 0; i + 3 < pathSize; i++) {
+            for (unsigned long j = i + 2; j + 1 < pathSize; j++) {
+                double delta = metric(path[i], path[j]) + metric(path[i + 1], path[j + 1]) -
+                               metric(path[i], path[i + 1]) - metric(path[j], path[j + 1]);
+                if (delta < -TSP_REFINE_EPSILON) {
+                    std::reverse(path + i + 1, path + j + 1);
+                    improved = true;
+                }
+            }
+        }
+
+        while (moveSegment(path, pathSize, metric)) improved = true;
+    }
+}
+
+template<class Metric>
+bool DecompositionSolver::moveSegment(unsigned long* path, unsigned long pathSize, const Metric &metric) {
+    for (unsigned long length = 1; length <= 3; length++) {
+        /// the segment path[i] to path[i+length-1] is between path[i-1] and path[i+length]
+        for (unsigned long i = 1; i + length < pathSize; i++) {
+            unsigned long before = path[i - 1], start = path[i], end = path[i + length - 1], after = path[i + length];
+            double removeGain = metric(before, start) + metric(end, after) - metric(before, after);
+
+            /// insert it between path[j] and path[j+1], which is not next to the segment
+            for (unsigned long j = 0; j + 1 < pathSize; j++) {
+                if (j + 1 >= i && j < i + length) continue;
+
+                double edge = metric(path[j], path[j + 1]);
+                double forward = metric(path[j], start) + metric(end, path[j + 1]) - edge;
+                double reversed = metric(path[j], end) + metric(start, path[j + 1]) - edge;
+                if (std::min(forward, reversed) - removeGain >= -TSP_REFINE_EPSILON) continue;
+
+                unsigned long position;
+                if (j < i) {
+                    std::rotate(path + j + 1, path + i, path + i + length);
+                    position = j + 1;
+                } else {
+                    std::rotate(path + i, path + i + length, path + j + 1);
+                    position = j + 1 - length;
+                }
+                if (reversed < forward) std::reverse(path + position, path + position + length);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void DecompositionSolver::writeRoute(const std::string &fileName, const DecompositionSolution &solution) const {
+    /// every point index is written with the same width, so the file offset follows from the offset in the route
+    int width = (int) std::to_string(solution.nPoints > 0 ? solution.nPoints - 1 : 0).size();
+    std::string text;
+    text.reserve(solution.order.size() * (width + 1));
+    char line[32];
+    for (auto &point : solution.order) {
+        snprintf(line, sizeof(line), "%*lu\n", width, point);
+        text += line;
+    }
+
+    MPI_File file;
+    int rc = MPI_File_open(comm, fileName.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file);
+    if (rc != MPI_SUCCESS) {
+        std::cerr << "could not open output file " << fileName << std::endl;
+        exit(-1);
+    }
+    MPI_File_set_size(file, 0);
+    MPI_File_write_at_all(file, (MPI_Offset) (solution.offset * (width + 1)), text.data(), (int) text.size(),
+                          MPI_CHAR, MPI_STATUS_IGNORE);
+    MPI_File_close(&file);
+}
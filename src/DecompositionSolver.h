@@ -0,0 +1,136 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_DECOMPOSITIONSOLVER_H
+#define GATSP_DECOMPOSITIONSOLVER_H
+
+
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+#include "TSPSolver.h"
+
+struct DecompositionSolution {
+    double routeLength = 0.0;
+    unsigned long nPoints = 0;
+    unsigned long nClusters = 0;
+
+    /// the part of the route owned by this process, which starts at position offset of the route
+    unsigned long offset = 0;
+    std::vector<unsigned long> order;
+};
+
+/**
+ * @brief solve instances too large for a single population by spatial decomposition
+ *
+ * The points are divided into clusters of at most params.clusterSize points by recursively bisecting them at the
+ * median of their widest coordinate. The clusters are ordered by a route over their centroids, solved by the genetic
+ * algorithm on all processes, and every process solves a contiguous range of this route of clusters, each cluster on
+ * its own (MPI_COMM_SELF) as a path from the point where the route enters it to the point where it leaves it.
+ *
+ * The paths are stitched in place, so every process owns a contiguous part of the route and the route is never
+ * gathered. The params.jointWindow points on either side of every joint between clusters are refined with 2-opt and
+ * Or-opt moves, keeping the ends of the window fixed. Joints between processes are refined by the next process, which
+ * receives the end of the route part of the previous process and sends the refined end back.
+ */
+class DecompositionSolver {
+private:
+    MPI_Comm comm;
+    int id, nTasks;
+    TSPSolver clusterSolver;
+    TSPSolver centroidSolver;
+
+    unsigned long nPoints = 0;
+    unsigned long nClusters = 0;
+
+    /// the points of cluster c are pointIndex[clusterStart[c]] to pointIndex[clusterStart[c + 1] - 1]
+    std::vector<unsigned long> pointIndex;
+    std::vector<unsigned long> clusterStart;
+    std::vector<double> xCentroids;
+    std::vector<double> yCentroids;
+
+    /// the route over the clusters, and the points where it enters and leaves the cluster at every position
+    std::vector<unsigned long> clusterOrder;
+    std::vector<unsigned long> entryPoints;
+    std::vector<unsigned long> exitPoints;
+
+    /// the number of points of the route before every position of the route over the clusters
+    std::vector<unsigned long> routeStart;
+
+    /**
+     * @brief divide the points into clusters by recursive bisection, the same on every process
+     */
+    void setClusters(const TSPInstance &instance, unsigned long clusterSize);
+
+    /**
+     * @brief set the route over the centroids of the clusters (collective over the communicator)
+     */
+    void setClusterOrder(const TSPInstance &instance, const TSPParameters &params);
+
+    /**
+     * @brief set the entry and exit point of every cluster, the same on every process
+     */
+    template<class Metric>
+    void setJoints(const TSPInstance &instance, const Metric &metric);
+
+    /**
+     * @brief return the first position of the route over the clusters that is solved by the process
+     */
+    [[nodiscard]] unsigned long getFirstPosition(int process) const;
+
+    /**
+     * @brief return the next process in the direction of step (1 or -1) that solves at least one cluster
+     */
+    [[nodiscard]] int getNextProcess(int process, int step) const;
+
+    /**
+     * @brief return the route through the cluster at the position of the route over the clusters, from its entry to
+     * its exit point
+     */
+    template<class Metric>
+    std::vector<unsigned long> solveCluster(const TSPInstance &instance, const TSPParameters &params,
+                                            unsigned long position, const Metric &metric);
+
+    /**
+     * @brief refine the joints between processes, where each process refines the joint with the previous process
+     */
+    template<class Metric>
+    void refineProcessJoints(std::vector<unsigned long> &order, unsigned long jointWindow, const Metric &metric);
+
+    /**
+     * @brief improve the path with 2-opt and Or-opt moves until it is locally optimal, keeping its first and last
+     * point in place
+     */
+    template<class Metric>
+    static void refinePath(unsigned long* path, unsigned long pathSize, const Metric &metric);
+
+    /**
+     * @brief apply the first improving Or-opt move (move 1 to 3 points elsewhere, possibly reversed), return false if
+     * there is none
+     */
+    template<class Metric>
+    static bool moveSegment(unsigned long* path, unsigned long pathSize, const Metric &metric);
+
+    template<class Metric>
+    DecompositionSolution solve(const TSPInstance &instance, const TSPParameters &params, const Metric &metric);
+
+public:
+    explicit DecompositionSolver(MPI_Comm comm_ = MPI_COMM_WORLD);
+
+    /**
+     * @brief solve the instance of points (collective over the communicator), return the length of the route and
+     * the part of it owned by this process
+     */
+    DecompositionSolution solve(const TSPInstance &instance, const TSPParameters &params);
+
+    /**
+     * @brief write the route to a text file with one point index per line, every process writing its own part with
+     * MPI-IO (collective over the communicator)
+     */
+    void writeRoute(const std::string &fileName, const DecompositionSolution &solution) const;
+};
+
+
+#endif //GATSP_DECOMPOSITIONSOLVER_H
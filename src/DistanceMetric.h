@@ -0,0 +1,185 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_DISTANCEMETRIC_H
+#define GATSP_DISTANCEMETRIC_H
+
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Distance metrics used as compile-time policies by TSPRoute and TravellingSalesman.
+ *
+ * Every metric returns the distance from point a to point b with operator(), and a value with the same ordering as
+ * the distance with compare(), which the greedy crossover uses to choose the closest next city. Metrics with
+ * symmetric == false are only walked in the direction of the route.
+ */
+
+enum class MetricType {
+    euclidean,
+    manhattan,
+    geographic,
+    matrix,
+    asymmetricMatrix,
+};
+
+struct EuclideanMetric {
+    static constexpr bool symmetric = true;
+    const double* xPoints;
+    const double* yPoints;
+
+    [[nodiscard]] inline double compare(unsigned long a, unsigned long b) const {
+        double dx = xPoints[a] - xPoints[b];
+        double dy = yPoints[a] - yPoints[b];
+        return dx * dx + dy * dy;
+    }
+
+    inline double operator()(unsigned long a, unsigned long b) const {
+        return std::sqrt(compare(a, b));
+    }
+};
+
+struct ManhattanMetric {
+    static constexpr bool symmetric = true;
+    const double* xPoints;
+    const double* yPoints;
+
+    [[nodiscard]] inline double compare(unsigned long a, unsigned long b) const {
+        return (*this)(a, b);
+    }
+
+    inline double operator()(unsigned long a, unsigned long b) const {
+        return std::abs(xPoints[a] - xPoints[b]) + std::abs(yPoints[a] - yPoints[b]);
+    }
+};
+
+/**
+ * @brief great-circle distance in km, with x the latitude and y the longitude in degrees
+ */
+struct GeographicMetric {
+    static constexpr bool symmetric = true;
+    static constexpr double earthRadius = 6371.0;
+    static constexpr double degToRad = M_PI / 180.0;
+    const double* xPoints;
+    const double* yPoints;
+
+    /// haversine of the central angle, which increases monotonically with the distance
+    [[nodiscard]] inline double compare(unsigned long a, unsigned long b) const {
+        double sinLat = std::sin(0.5 * degToRad * (xPoints[b] - xPoints[a]));
+        double sinLon = std::sin(0.5 * degToRad * (yPoints[b] - yPoints[a]));
+        return sinLat * sinLat +
+               std::cos(degToRad * xPoints[a]) * std::cos(degToRad * xPoints[b]) * sinLon * sinLon;
+    }
+
+    inline double operator()(unsigned long a, unsigned long b) const {
+        return 2.0 * earthRadius * std::asin(std::sqrt(std::min(1.0, compare(a, b))));
+    }
+};
+
+/**
+ * @brief explicit nPoints x nPoints distance matrix in row-major order, where matrix[a * nPoints + b] is from a to b
+ */
+template<bool isSymmetric>
+struct ExplicitMatrixMetric {
+    static constexpr bool symmetric = isSymmetric;
+    const double* matrix;
+    unsigned long nPoints;
+
+    [[nodiscard]] inline double compare(unsigned long a, unsigned long b) const {
+        return matrix[a * nPoints + b];
+    }
+
+    inline double operator()(unsigned long a, unsigned long b) const {
+        return matrix[a * nPoints + b];
+    }
+};
+
+using MatrixMetric = ExplicitMatrixMetric<true>;
+using AsymmetricMatrixMetric = ExplicitMatrixMetric<false>;
+
+/**
+ * @brief precomputed distance matrix of an instance with at most N points, padded to N x N
+ *
+ * The row length is a compile-time constant, so indexing is a shift instead of a multiplication, and TSPRoute uses N
+ * to build routes in fixed-size arrays with a bitmask of visited cities.
+ */
+template<unsigned long N, bool isSymmetric>
+struct SmallMatrixMetric {
+    static constexpr bool symmetric = isSymmetric;
+    const double* matrix;
+
+    [[nodiscard]] inline double compare(unsigned long a, unsigned long b) const {
+        return matrix[a * N + b];
+    }
+
+    inline double operator()(unsigned long a, unsigned long b) const {
+        return matrix[a * N + b];
+    }
+};
+
+/**
+ * @brief maximum number of points of a metric known at compile time, 0 if the metric supports any number of points
+ */
+template<class Metric>
+constexpr unsigned long fixedSize = 0;
+
+template<unsigned long N, bool isSymmetric>
+constexpr unsigned long fixedSize<SmallMatrixMetric<N, isSymmetric>> = N;
+
+/**
+ * @brief return the smallest fixed size of SmallMatrixMetric with at least nPoints points, 0 if there is none
+ */
+inline unsigned long getSmallMatrixSize(unsigned long nPoints) {
+    for (unsigned long size : {64ul, 128ul, 256ul}) {
+        if (nPoints <= size) return size;
+    }
+    return 0;
+}
+
+/**
+ * @brief call function with the metric of the specified type, so every metric gets its own instantiation
+ */
+template<class Function>
+inline void withMetric(MetricType metricType, const double* xPoints, const double* yPoints,
+                       const double* matrix, unsigned long nPoints, Function &&function) {
+    switch (metricType) {
+        case MetricType::euclidean:
+            function(EuclideanMetric{xPoints, yPoints});
+            break;
+        case MetricType::manhattan:
+            function(ManhattanMetric{xPoints, yPoints});
+            break;
+        case MetricType::geographic:
+            function(GeographicMetric{xPoints, yPoints});
+            break;
+        case MetricType::matrix:
+            function(MatrixMetric{matrix, nPoints});
+            break;
+        case MetricType::asymmetricMatrix:
+            function(AsymmetricMatrixMetric{matrix, nPoints});
+            break;
+    }
+}
+
+/**
+ * @brief call function with the SmallMatrixMetric of the given size, which has to be returned by getSmallMatrixSize
+ */
+template<bool isSymmetric, class Function>
+inline void withSmallMatrixMetric(unsigned long size, const double* matrix, Function &&function) {
+    switch (size) {
+        case 64:
+            function(SmallMatrixMetric<64, isSymmetric>{matrix});
+            break;
+        case 128:
+            function(SmallMatrixMetric<128, isSymmetric>{matrix});
+            break;
+        default:
+            function(SmallMatrixMetric<256, isSymmetric>{matrix});
+            break;
+    }
+}
+
+
+#endif //GATSP_DISTANCEMETRIC_H
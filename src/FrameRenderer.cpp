@@ -0,0 +1,95 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include "FrameRenderer.h"
+#include "PNGImage.h"
+
+FrameRenderer::FrameRenderer(const std::vector<double> &xPoints_, const std::vector<double> &yPoints_,
+                             unsigned long imageSize_)
+        : xPoints(xPoints_), yPoints(yPoints_), imageSize(imageSize_) {
+    if (xPoints.empty()) return;
+
+    /// fit the bounding box of the points in the center of the image, leaving a margin of 5%
+    auto [xMinPoint, xMaxPoint] = std::minmax_element(xPoints.begin(), xPoints.end());
+    auto [yMinPoint, yMaxPoint] = std::minmax_element(yPoints.begin(), yPoints.end());
+    xMin = *xMinPoint;
+    yMax = *yMaxPoint;
+    double width = *xMaxPoint - xMin;
+    double height = yMax - *yMinPoint;
+
+    margin = 0.05 * (double) imageSize;
+    double size = (double) imageSize - 2.0 * margin;
+    scale = std::max(width, height) > 0.0 ? size / std::max(width, height) : 1.0;
+    xOffset = margin + 0.5 * (size - width * scale);
+    yOffset = margin + 0.5 * (size - height * scale);
+}
+
+double FrameRenderer::getX(unsigned long point) const {
+    return xOffset + (xPoints[point] - xMin) * scale;
+}
+
+double FrameRenderer::getY(unsigned long point) const {
+    return yOffset + (yMax - yPoints[point]) * scale;
+}
+
+void FrameRenderer::render(FrameFormat format, unsigned long generation, double routeLength,
+                           const std::vector<unsigned long> &order, const std::string &fileName) const {
+    if (format == FrameFormat::png) {
+        renderPNG(order, fileName);
+    } else {
+        renderSVG(generation, routeLength, order, fileName);
+    }
+}
+
+void FrameRenderer::renderPNG(const std::vector<unsigned long> &order, const std::string &fileName) const {
+    PNGImage image(imageSize, imageSize);
+
+    /// draw the closed route first, so the points are drawn on top of it
+    unsigned long nPoints = order.size();
+    for (unsigned long i = 0; i < nPoints; i++) {
+        unsigned long a = order[i], b = order[(i + 1) % nPoints];
+        image.drawLine(std::lround(getX(a)), std::lround(getY(a)), std::lround(getX(b)), std::lround(getY(b)),
+                       PNGImage::red);
+    }
+
+    long radius = nPoints > 1000 ? 0 : 1;
+    for (unsigned long i = 0; i < xPoints.size(); i++) {
+        image.drawPoint(std::lround(getX(i)), std::lround(getY(i)), radius, PNGImage::black);
+    }
+
+    image.write(fileName);
+}
+
+void FrameRenderer::renderSVG(unsigned long generation, double routeLength, const std::vector<unsigned long> &order,
+                              const std::string &fileName) const {
+    FILE* file = fopen(fileName.c_str(), "w");
+    if (file == nullptr) {
+        std::cerr << "could not open output file " << fileName << std::endl;
+        exit(-1);
+    }
+
+    fprintf(file, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%lu\" height=\"%lu\">\n", imageSize, imageSize);
+    fprintf(file, "<rect width=\"100%%\" height=\"100%%\" fill=\"white\"/>\n");
+    fprintf(file, "<text x=\"%f\" y=\"%f\" font-family=\"sans-serif\" font-size=\"%f\">"
+                  "generation: %lu  -  path length: %f</text>\n",
+            margin, 0.7 * margin, 0.4 * margin, generation, routeLength);
+
+    fprintf(file, "<polygon fill=\"none\" stroke=\"red\" points=\"");
+    for (auto &point : order) {
+        fprintf(file, "%.2f,%.2f ", getX(point), getY(point));
+    }
+    fprintf(file, "\"/>\n");
+
+    double radius = order.size() > 1000 ? 0.5 : 2.0;
+    for (unsigned long i = 0; i < xPoints.size(); i++) {
+        fprintf(file, "<circle cx=\"%.2f\" cy=\"%.2f\" r=\"%.1f\"/>\n", getX(i), getY(i), radius);
+    }
+    fprintf(file, "</svg>\n");
+
+    fclose(file);
+}
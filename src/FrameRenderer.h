@@ -0,0 +1,62 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_FRAMERENDERER_H
+#define GATSP_FRAMERENDERER_H
+
+
+#include <string>
+#include <vector>
+
+enum class FrameFormat {
+    png,
+    svg,
+};
+
+/**
+ * @brief draws the points and a route of a run log as a PNG or SVG frame
+ *
+ * The points are scaled to fit a square image, keeping their aspect ratio. Rendering only reads the renderer, so
+ * frames can be rendered by multiple threads at the same time.
+ */
+class FrameRenderer {
+private:
+    const std::vector<double> &xPoints;
+    const std::vector<double> &yPoints;
+    unsigned long imageSize;
+
+    double xMin = 0.0;
+    double yMax = 0.0;
+    double scale = 1.0;
+    double margin = 0.0;
+    double xOffset = 0.0;
+    double yOffset = 0.0;
+
+    /**
+    * @brief return the pixel coordinates of the point, with y pointing down
+    */
+    [[nodiscard]] double getX(unsigned long point) const;
+
+    [[nodiscard]] double getY(unsigned long point) const;
+
+    void renderPNG(const std::vector<unsigned long> &order, const std::string &fileName) const;
+
+    void renderSVG(unsigned long generation, double routeLength, const std::vector<unsigned long> &order,
+                   const std::string &fileName) const;
+
+public:
+    /**
+    * @brief create a renderer of imageSize x imageSize pixels for the points, which have to stay valid
+    */
+    FrameRenderer(const std::vector<double> &xPoints_, const std::vector<double> &yPoints_, unsigned long imageSize_);
+
+    /**
+    * @brief draw the points and the closed route through them to the file
+    */
+    void render(FrameFormat format, unsigned long generation, double routeLength,
+                const std::vector<unsigned long> &order, const std::string &fileName) const;
+};
+
+
+#endif //GATSP_FRAMERENDERER_H
@@ -0,0 +1,294 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+#include "HeldKarpBound.h"
+#include "TSPInstance.h"
+
+#define TSP_BOUND_N_NEIGHBOURS 10                       // number of nearest neighbours used as candidate edges
+
+HeldKarpBound::HeldKarpBound(MPI_Comm comm_) : comm(comm_) {
+    MPI_Comm_rank(comm, &id);
+    MPI_Comm_size(comm, &nTasks);
+}
+
+double HeldKarpBound::compute(const TSPInstance &instance, unsigned long maxIterations) {
+    nPoints = instance.nPoints;
+
+    /// divide the points 1 to n-1 of the spanning tree between the processes
+    unsigned long nTreePoints = nPoints - 1;
+    first = 1 + nTreePoints * id / nTasks;
+    last = 1 + nTreePoints * (id + 1) / nTasks;
+
+    penalties.assign(nPoints, 0.0);
+    key.resize(nPoints);
+    parent.resize(nPoints);
+    inTree.resize(nPoints);
+    degree.resize(nPoints);
+
+    double bound = 0.0;
+    withMetric(instance.metric, instance.xPoints, instance.yPoints, instance.matrix, nPoints,
+               [this, &instance, &bound, maxIterations](const auto &metric) {
+                   if constexpr (std::remove_reference_t<decltype(metric)>::symmetric) {
+                       neighbourLists.build(instance, TSP_BOUND_N_NEIGHBOURS, comm);
+                       bound = compute(metric, maxIterations);
+                   }
+               });
+
+    return bound;
+}
+
+template<class Metric>
+double HeldKarpBound::compute(const Metric &metric, unsigned long maxIterations) {
+    /// without connected candidate edges every step uses the complete graph
+    bool useCandidates = setCandidates();
+
+    double upperBound = getNearestNeighbourLength(metric);
+    double bestBound = std::numeric_limits<double>::lowest();
+    std::vector<double> bestPenalties = penalties;
+    double stepFactor = 2.0;
+    unsigned long nNoImprovement = 0;
+
+    for (unsigned long iteration = 0; iteration < maxIterations; iteration++) {
+        /// the length of the 1-tree minus twice the sum of penalties is a lower bound
+        double penaltySum = 0.0;
+        for (auto &penalty : penalties) penaltySum += penalty;
+        double oneTreeLength = useCandidates ? setCandidateOneTree(metric) : setOneTree(metric);
+        double bound = oneTreeLength - 2.0 * penaltySum;
+
+        /// halve the step size if the bound has not improved for a while
+        if (bound > bestBound) {
+            bestBound = bound;
+            bestPenalties = penalties;
+            nNoImprovement = 0;
+        } else if (++nNoImprovement >= 10) {
+            stepFactor /= 2.0;
+            nNoImprovement = 0;
+        }
+
+        /// stop if the 1-tree is a route (all degrees are 2) or the step size is negligible
+        double norm = 0.0;
+        for (unsigned long i = 0; i < nPoints; i++) {
+            norm += (double) ((degree[i] - 2) * (degree[i] - 2));
+        }
+        if (norm == 0.0 || stepFactor < 1e-6) break;
+
+        /// move the penalties along the subgradient, the same on every process
+        double step = stepFactor * (upperBound - bound) / norm;
+        for (unsigned long i = 0; i < nPoints; i++) {
+            penalties[i] += step * (degree[i] - 2);
+        }
+    }
+
+    if (!useCandidates) return std::max(bestBound, 0.0);
+
+    /// the bound on the candidate edges may be too high, compute the bound on the complete graph
+    penalties = bestPenalties;
+    double penaltySum = 0.0;
+    for (auto &penalty : penalties) penaltySum += penalty;
+
+    return std::max(setOneTree(metric) - 2.0 * penaltySum, 0.0);
+}
+
+bool HeldKarpBound::setCandidates() {
+    /// add every nearest neighbour edge in both directions
+    candidates.assign(nPoints, {});
+    unsigned long k = neighbourLists.getK();
+    for (unsigned long i = 0; i < nPoints; i++) {
+        const unsigned long* neighbours = neighbourLists.getNeighbours(i);
+        for (unsigned long j = 0; j < k; j++) {
+            candidates[i].push_back(neighbours[j]);
+            candidates[neighbours[j]].push_back(i);
+        }
+    }
+    for (auto &list : candidates) {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+
+    /// check if the points 1 to n-1 are connected without point 0
+    std::vector<bool> reached(nPoints, false);
+    std::vector<unsigned long> stack = {1};
+    reached[0] = reached[1] = true;
+    unsigned long nReached = 2;
+    while (!stack.empty()) {
+        unsigned long i = stack.back();
+        stack.pop_back();
+        for (auto &j : candidates[i]) {
+            if (!reached[j]) {
+                reached[j] = true;
+                nReached++;
+                stack.push_back(j);
+            }
+        }
+    }
+
+    return nReached == nPoints;
+}
+
+template<class Metric>
+double HeldKarpBound::setOneTree(const Metric &metric) {
+    auto cost = [this, &metric](unsigned long a, unsigned long b) {
+        return metric(a, b) + penalties[a] + penalties[b];
+    };
+
+    std::fill(degree.begin(), degree.end(), 0);
+    std::fill(inTree.begin(), inTree.end(), false);
+
+    /// start the spanning tree with point 1, every process keeps the distance to the tree for its own points
+    double length = 0.0;
+    inTree[1] = true;
+    for (unsigned long j = first; j < last; j++) {
+        key[j] = cost(1, j);
+        parent[j] = 1;
+    }
+
+    struct {
+        double key;
+        int index;
+    } local{}, global{};
+
+    for (unsigned long step = 2; step < nPoints; step++) {
+        /// find the closest point to the tree over all processes
+        local.key = std::numeric_limits<double>::max();
+        local.index = -1;
+        for (unsigned long j = first; j < last; j++) {
+            if (!inTree[j] && key[j] < local.key) {
+                local.key = key[j];
+                local.index = (int) j;
+            }
+        }
+        MPI_Allreduce(&local, &global, 1, MPI_DOUBLE_INT, MPI_MINLOC, comm);
+
+        /// add the point to the tree, the owning process counts the degrees of the new edge
+        auto v = (unsigned long) global.index;
+        inTree[v] = true;
+        length += global.key;
+        if (v >= first && v < last) {
+            degree[v]++;
+            degree[parent[v]]++;
+        }
+
+        for (unsigned long j = first; j < last; j++) {
+            if (!inTree[j]) {
+                double c = cost(v, j);
+                if (c < key[j]) {
+                    key[j] = c;
+                    parent[j] = v;
+                }
+            }
+        }
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, degree.data(), (int) nPoints, MPI_INT, MPI_SUM, comm);
+
+    return length + addPointZero(metric);
+}
+
+template<class Metric>
+double HeldKarpBound::setCandidateOneTree(const Metric &metric) {
+    auto cost = [this, &metric](unsigned long a, unsigned long b) {
+        return metric(a, b) + penalties[a] + penalties[b];
+    };
+
+    std::fill(degree.begin(), degree.end(), 0);
+    std::fill(inTree.begin(), inTree.end(), false);
+    std::fill(key.begin(), key.end(), std::numeric_limits<double>::max());
+
+    /// Prim's algorithm with a heap of (cost, point) pairs, point 0 is never added to the tree
+    using Edge = std::pair<double, unsigned long>;
+    std::priority_queue<Edge, std::vector<Edge>, std::greater<>> heap;
+    double length = 0.0;
+    inTree[0] = true;
+    key[1] = 0.0;
+    heap.emplace(0.0, 1);
+
+    while (!heap.empty()) {
+        auto [c, v] = heap.top();
+        heap.pop();
+        if (inTree[v] || c > key[v]) continue;
+
+        inTree[v] = true;
+        length += c;
+        if (v != 1) {
+            degree[v]++;
+            degree[parent[v]]++;
+        }
+
+        for (auto &j : candidates[v]) {
+            if (inTree[j]) continue;
+            double cj = cost(v, j);
+            if (cj < key[j]) {
+                key[j] = cj;
+                parent[j] = v;
+                heap.emplace(cj, j);
+            }
+        }
+    }
+
+    return length + addPointZero(metric);
+}
+
+template<class Metric>
+double HeldKarpBound::addPointZero(const Metric &metric) {
+    double min1 = std::numeric_limits<double>::max(), min2 = min1;
+    unsigned long j1 = 1, j2 = 1;
+    for (unsigned long j = 1; j < nPoints; j++) {
+        double c = metric(0, j) + penalties[0] + penalties[j];
+        if (c < min1) {
+            min2 = min1;
+            j2 = j1;
+            min1 = c;
+            j1 = j;
+        } else if (c < min2) {
+            min2 = c;
+            j2 = j;
+        }
+    }
+
+    degree[0] += 2;
+    degree[j1]++;
+    degree[j2]++;
+
+    return min1 + min2;
+}
+
+template<class Metric>
+double HeldKarpBound::getNearestNeighbourLength(const Metric &metric) const {
+    std::vector<bool> visited(nPoints, false);
+    unsigned long current = 0;
+    visited[0] = true;
+    double length = 0.0;
+
+    for (unsigned long step = 1; step < nPoints; step++) {
+        /// take the nearest unvisited neighbour, or search all points if all neighbours are visited
+        unsigned long next = nPoints;
+        const unsigned long* neighbours = neighbourLists.getNeighbours(current);
+        for (unsigned long j = 0; j < neighbourLists.getK(); j++) {
+            if (!visited[neighbours[j]]) {
+                next = neighbours[j];
+                break;
+            }
+        }
+
+        if (next == nPoints) {
+            double nextDist = std::numeric_limits<double>::max();
+            for (unsigned long j = 0; j < nPoints; j++) {
+                if (!visited[j] && metric.compare(current, j) < nextDist) {
+                    nextDist = metric.compare(current, j);
+                    next = j;
+                }
+            }
+        }
+
+        length += metric(current, next);
+        visited[next] = true;
+        current = next;
+    }
+
+    return length + metric(current, 0);
+}
@@ -0,0 +1,93 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_HELDKARPBOUND_H
+#define GATSP_HELDKARPBOUND_H
+
+
+#include <mpi.h>
+#include <vector>
+
+#include "NeighbourLists.h"
+
+struct TSPInstance;
+
+/**
+ * @brief Held-Karp lower bound on the optimal route length of a symmetric instance
+ *
+ * A 1-tree is a minimum spanning tree on the points 1 to n-1 plus the two cheapest edges of point 0, so its length is
+ * a lower bound on every route. Adding a penalty pi[i] to every edge of point i changes the length of every route by
+ * 2 * sum(pi), but not that of every 1-tree, so the bound is raised by subgradient optimisation of the penalties:
+ * points with a degree above 2 in the 1-tree get a higher penalty, points with degree 1 a lower one.
+ *
+ * The subgradient steps use 1-trees on the graph of the nearest neighbours of every point, which takes
+ * O(n k log n) per step. Only the final bound, with the best penalties, is computed on the complete graph with
+ * Prim's algorithm, which makes it a valid bound. Every process owns a range of the points, and in every step of
+ * Prim's algorithm the closest point to the tree is found with an MPI_Allreduce (MPI_MINLOC).
+ */
+class HeldKarpBound {
+private:
+    MPI_Comm comm;
+    int id, nTasks;
+
+    unsigned long nPoints = 0;
+    unsigned long first = 0;
+    unsigned long last = 0;
+
+    NeighbourLists neighbourLists;
+    std::vector<std::vector<unsigned long>> candidates;
+
+    std::vector<double> penalties;
+    std::vector<double> key;
+    std::vector<unsigned long> parent;
+    std::vector<bool> inTree;
+    std::vector<int> degree;
+
+    /**
+     * @brief set the candidate edges (the symmetric nearest neighbour graph), return false if the points 1 to n-1
+     * are not connected by them
+     */
+    bool setCandidates();
+
+    /**
+     * @brief compute the 1-tree with penalties on the complete graph, set the degree of every point and return its
+     * length (collective over the communicator)
+     */
+    template<class Metric>
+    double setOneTree(const Metric &metric);
+
+    /**
+     * @brief compute the 1-tree with penalties on the candidate edges, set the degree of every point and return its
+     * length (local to the process)
+     */
+    template<class Metric>
+    double setCandidateOneTree(const Metric &metric);
+
+    /**
+     * @brief connect point 0 to the 1-tree with its two cheapest edges and return their length
+     */
+    template<class Metric>
+    double addPointZero(const Metric &metric);
+
+    /**
+     * @brief return the length of the nearest neighbour route starting at point 0, used to scale the step size
+     */
+    template<class Metric>
+    double getNearestNeighbourLength(const Metric &metric) const;
+
+    template<class Metric>
+    double compute(const Metric &metric, unsigned long maxIterations);
+
+public:
+    explicit HeldKarpBound(MPI_Comm comm_);
+
+    /**
+     * @brief return the lower bound after at most maxIterations subgradient steps (collective over the communicator),
+     * or 0.0 for an asymmetric instance
+     */
+    double compute(const TSPInstance &instance, unsigned long maxIterations);
+};
+
+
+#endif //GATSP_HELDKARPBOUND_H
@@ -2,53 +2,32 @@
 // Created by thijs on 25-04-22.
 //
 
-#include "MPIController.h"
-
+#include <algorithm>
 
-MPIController::MPIController(int argc, char** argv, unsigned long nMigrate_) {
-    /// set relevant input variables
-    char* pEnd;
-    unsigned long populationSize = strtol(*++argv, &pEnd, 10);
-    ++argv;
-    nPoints = strtol(*++argv, &pEnd, 10);
-    ++argv;
-    ++argv;
-    cout = argc > 6 ? strtol(*++argv, &pEnd, 10) : 0;
-
-    /// initialize MPI
-    rc = MPI_Init(&argc, &argv);
-    if (rc != MPI_SUCCESS) {
-        printf("MPI initialization failed\n");
-        exit(-1);
-    }
-
-    nTasks = id = pnLength = {};
-    rc = MPI_Comm_size(MPI_COMM_WORLD, &nTasks);
-    rc = MPI_Comm_rank(MPI_COMM_WORLD, &id);
-    rc = MPI_Get_processor_name(pName, &pnLength);
+#include "MPIController.h"
 
-    if (id == 0) {
-        printf("MPI initialized\n");
-    }
 
-    if (populationSize < 2 * nMigrate_ * nTasks) {
-        std::cerr << "pop_size should be larger than twice the migrating population times number of processes"
-                  << std::endl;
-        exit(-1);
-    }
+MPIController::MPIController(MPI_Comm comm_) : comm(comm_) {
+    nTasks = id = {};
+    rc = MPI_Comm_size(comm, &nTasks);
+    rc = MPI_Comm_rank(comm, &id);
 
     /// set left and right neighbouring ids
     leftID = (id == 0) ? nTasks - 1 : id - 1;
     rightID = (id == nTasks - 1) ? 0 : id + 1;
+}
 
-    /// initialize the mpi buffer
-    nMigrate = nMigrate_;
-    mpiBufferSize = MPI_BSEND_OVERHEAD + sizeof(unsigned long) * nMigrate * nPoints * 2;
-    mpiBuffer = new char[mpiBufferSize];
-    MPI_Buffer_attach(mpiBuffer, mpiBufferSize);
+MPIController::~MPIController() {
+    stopFlagsReduceFinish();
+    MPI_Waitall(2, metricsRequests, MPI_STATUSES_IGNORE);
 
-    /// open the file tsp.dat
-    if (cout > 0 && id == 0) file = fopen("tsp.dat", "w");
+    /// the last controller using the buffer detaches it
+    if (usesBuffer && --nBufferUsers == 0) {
+        MPI_Buffer_detach(&mpiBuffer, &mpiBufferSize);
+        delete[] mpiBuffer;
+        mpiBuffer = nullptr;
+        mpiBufferSize = 0;
+    }
 }
 
 int MPIController::getNTasks() const {
@@ -63,14 +42,41 @@ unsigned long MPIController::getNMigrate() const {
     return nMigrate;
 }
 
+MPI_Comm MPIController::getComm() const {
+    return comm;
+}
+
+void MPIController::setMigrationSize(unsigned long nPoints_, unsigned long nMigrate_) {
+    nPoints = nPoints_;
+    nMigrate = nMigrate_;
+
+    if (!usesBuffer) {
+        usesBuffer = true;
+        nBufferUsers++;
+    }
+
+    /// keep the attached buffer if it is large enough for two migration messages
+    int requiredSize = (int) (MPI_BSEND_OVERHEAD + sizeof(unsigned long) * nMigrate * nPoints) * 2;
+    if (mpiBuffer != nullptr && mpiBufferSize >= requiredSize) return;
+
+    if (mpiBuffer != nullptr) {
+        MPI_Buffer_detach(&mpiBuffer, &mpiBufferSize);
+        delete[] mpiBuffer;
+    }
+
+    mpiBufferSize = requiredSize;
+    mpiBuffer = new char[mpiBufferSize];
+    MPI_Buffer_attach(mpiBuffer, mpiBufferSize);
+}
+
 void MPIController::orderBufferSend(unsigned long* data, Neighbour neighbour) {
     rc = MPI_Bsend(data, (int) (nPoints * nMigrate), MPI_UNSIGNED_LONG,
-                   neighbour == Neighbour::left ? leftID : rightID, tag, MPI_COMM_WORLD);
+                   neighbour == Neighbour::left ? leftID : rightID, tag, comm);
 }
 
 void MPIController::orderBufferReceive(unsigned long* data, Neighbour neighbour) {
     rc = MPI_Recv(data, (int) (nPoints * nMigrate), MPI_UNSIGNED_LONG,
-                  neighbour == Neighbour::left ? leftID : rightID, tag, MPI_COMM_WORLD, &status);
+                  neighbour == Neighbour::left ? leftID : rightID, tag, comm, &status);
 }
 
 void MPIController::sendBufferedMessages() {
@@ -78,48 +84,72 @@ void MPIController::sendBufferedMessages() {
     MPI_Buffer_attach(mpiBuffer, mpiBufferSize);
 }
 
-void MPIController::pointsBroadcast(double* xPoints, double* yPoints) {
-    rc = MPI_Bcast(xPoints, (int) nPoints, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    rc = MPI_Bcast(yPoints, (int) nPoints, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+void MPIController::allgatherThroughput(double throughput, unsigned long size,
+                                        double* allThroughputs, unsigned long* allSizes) {
+    rc = MPI_Allgather(&throughput, 1, MPI_DOUBLE, allThroughputs, 1, MPI_DOUBLE, comm);
+    rc = MPI_Allgather(&size, 1, MPI_UNSIGNED_LONG, allSizes, 1, MPI_UNSIGNED_LONG, comm);
 }
 
-void MPIController::printPointsToFile(unsigned long populationSize, unsigned long generations,
-                                      double xSize, double ySize, double* xPoints, double* yPoints) const {
-
-    if (id != 0 || cout == 0) return;
+void MPIController::ordersSend(unsigned long* data, unsigned long nOrders, int destination, MPI_Request* request) {
+    rc = MPI_Isend(data, (int) (nPoints * nOrders), MPI_UNSIGNED_LONG, destination, balanceTag, comm, request);
+}
 
-    fprintf(file, "%20s %20s %20s %20s %20s\n",
-            "population size", "generations", "number of points", "box size (x)", "box size (y)");
-    fprintf(file, "%20lu %20lu %20lu %20.10g %20.10g\n\n%20s %20s\n",
-            populationSize, generations, nPoints, xSize, ySize, "xPoints", "yPoints");
+void MPIController::ordersReceive(unsigned long* data, unsigned long nOrders, int source) {
+    rc = MPI_Recv(data, (int) (nPoints * nOrders), MPI_UNSIGNED_LONG, source, balanceTag, comm, &status);
+}
 
-    for (unsigned long i = 0; i < nPoints; i++) {
-        fprintf(file, "%20.10g %20.10g\n", xPoints[i], yPoints[i]);
-    }
-    fprintf(file, "\n\ngeneration, path-length, path-order[number of points in path]\n");
+void MPIController::stopFlagsReduceStart(bool stop, bool improving) {
+    stopFlags[0] = stop ? 1 : 0;
+    stopFlags[1] = improving ? 1 : 0;
+    rc = MPI_Iallreduce(stopFlags, globalStopFlags, 2, MPI_INT, MPI_MAX, comm, &stopRequest);
 }
 
-void MPIController::printPathToFile(unsigned long generation, double routeLength, unsigned long* order) {
-    if (cout <= 0 || id != 0) return;
+bool MPIController::stopFlagsReduceFinish() {
+    if (stopRequest == MPI_REQUEST_NULL) return false;
+
+    rc = MPI_Wait(&stopRequest, MPI_STATUS_IGNORE);
+    return globalStopFlags[0] != 0 || globalStopFlags[1] == 0;
+}
 
-    /// print the generation, route length and path order to file
-    fprintf(file, "%lu, %f, ", generation, routeLength);
-    for (unsigned long i = 0; i < nPoints; i++) {
-        fprintf(file, "%lu,", order[i]);
+void MPIController::metricsReduceStart(double bestRouteLength, double meanRouteLength, double diversity,
+                                       double migrationWaitTime, const MutationStatisticsArray &mutationStatistics) {
+    metricsMin[0] = bestRouteLength;
+    metricsSum[0] = meanRouteLength;
+    metricsSum[1] = diversity;
+    metricsSum[2] = migrationWaitTime;
+    for (unsigned long i = 0; i < nMutationOperators; i++) {
+        metricsSum[3 + 4 * i] = mutationStatistics[i].nApplied;
+        metricsSum[4 + 4 * i] = mutationStatistics[i].nImproved;
+        metricsSum[5 + 4 * i] = mutationStatistics[i].improvement;
+        metricsSum[6 + 4 * i] = mutationStatistics[i].time;
     }
-    fprintf(file, "%lu\n", order[0]);
+    int nSum = sizeof(metricsSum) / sizeof(metricsSum[0]);
+    rc = MPI_Ireduce(metricsMin, globalMetricsMin, 1, MPI_DOUBLE, MPI_MIN, 0, comm, &metricsRequests[0]);
+    rc = MPI_Ireduce(metricsSum, globalMetricsSum, nSum, MPI_DOUBLE, MPI_SUM, 0, comm, &metricsRequests[1]);
+}
 
-    /// print to terminal every 'cout' generations if cout is non-zero
-    if (cout > 0 && generation % cout == 0) {
-        std::cout << "generation: " << generation << "\nroute length: " << routeLength << ", path: ";
-        for (unsigned long i = 0; i < nPoints; i++) {
-            std::cout << order[i] << " ";
-        }
-        std::cout << std::endl;
+bool MPIController::metricsReduceFinish(double &bestRouteLength, double &meanRouteLength, double &diversity,
+                                        double &migrationWaitTime, MutationStatisticsArray &mutationStatistics) {
+    if (metricsRequests[0] == MPI_REQUEST_NULL) return false;
+
+    rc = MPI_Waitall(2, metricsRequests, MPI_STATUSES_IGNORE);
+    if (id != 0) return false;
+
+    /// the sums are averaged over the processes
+    bestRouteLength = globalMetricsMin[0];
+    meanRouteLength = globalMetricsSum[0] / nTasks;
+    diversity = globalMetricsSum[1] / nTasks;
+    migrationWaitTime = globalMetricsSum[2] / nTasks;
+    for (unsigned long i = 0; i < nMutationOperators; i++) {
+        mutationStatistics[i].nApplied = globalMetricsSum[3 + 4 * i];
+        mutationStatistics[i].nImproved = globalMetricsSum[4 + 4 * i];
+        mutationStatistics[i].improvement = globalMetricsSum[5 + 4 * i];
+        mutationStatistics[i].time = globalMetricsSum[6 + 4 * i];
     }
+    return true;
 }
 
-void MPIController::printBestPathToFile(unsigned long generation, double bestRouteLength, unsigned long* bestOrder) {
+bool MPIController::gatherBestPath(double &routeLength, unsigned long* order) {
 
     /// initialize and gather the best route order and route length from each process to process 0
     double* allRouteLengths = nullptr;
@@ -130,13 +160,13 @@ void MPIController::printBestPathToFile(unsigned long generation, double bestRou
         allBestOrders = new unsigned long[nTasks * nPoints];
     }
 
-    rc = MPI_Gather(&bestRouteLength, 1, MPI_DOUBLE,
-                    allRouteLengths, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    rc = MPI_Gather(&routeLength, 1, MPI_DOUBLE,
+                    allRouteLengths, 1, MPI_DOUBLE, 0, comm);
 
-    rc = MPI_Gather(&bestOrder[0], (int) nPoints, MPI_UNSIGNED_LONG,
-                    allBestOrders, (int) nPoints, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+    rc = MPI_Gather(&order[0], (int) nPoints, MPI_UNSIGNED_LONG,
+                    allBestOrders, (int) nPoints, MPI_UNSIGNED_LONG, 0, comm);
 
-    if (id != 0) return;
+    if (id != 0) return false;
 
     /// find global best route length
     int bestI = 0;
@@ -146,16 +176,23 @@ void MPIController::printBestPathToFile(unsigned long generation, double bestRou
         }
     }
 
-    /// print global best route length to file
-    printPathToFile(generation, allRouteLengths[bestI], &allBestOrders[bestI * nPoints]);
-}
+    routeLength = allRouteLengths[bestI];
+    std::copy(&allBestOrders[bestI * nPoints], &allBestOrders[(bestI + 1) * nPoints], order);
 
-void MPIController::finalize() {
-    MPI_Buffer_detach(&mpiBuffer, &mpiBufferSize);
-    delete[] mpiBuffer;
+    delete[] allRouteLengths;
+    delete[] allBestOrders;
+
+    return true;
+}
 
-    if (cout > 0 && id == 0) fclose(file);
+void MPIController::allreduceBestPath(double &routeLength, unsigned long* order) {
+    /// find the process with the shortest route and broadcast its order
+    struct {
+        double length;
+        int id;
+    } local{routeLength, id}, global{};
 
-    printf("\nhost %s (%d)\n", pName, id);
-    rc = MPI_Finalize();
+    rc = MPI_Allreduce(&local, &global, 1, MPI_DOUBLE_INT, MPI_MINLOC, comm);
+    rc = MPI_Bcast(order, (int) nPoints, MPI_UNSIGNED_LONG, global.id, comm);
+    routeLength = global.length;
 }
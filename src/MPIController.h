@@ -10,6 +10,8 @@
 #include <cmath>
 #include <vector>
 
+#include "Mutation.h"
+
 enum Neighbour : bool {
     left,
     right,
@@ -20,25 +22,44 @@ class TSPRoute;
 class MPIController {
 private:
     const int tag = 50;
-    int id, leftID, rightID, nTasks, rc, pnLength;
+    const int balanceTag = 51;
+    MPI_Comm comm;
+    int id, leftID, rightID, nTasks, rc;
     MPI_Status status{};
-    char pName[MPI_MAX_PROCESSOR_NAME]{};
 
-    unsigned long nMigrate;
-    int mpiBufferSize;
-    char* mpiBuffer;
-    unsigned long nPoints;
+    unsigned long nMigrate = 0;
+    unsigned long nPoints = 0;
+
+    /// MPI attaches one buffered send buffer per process, so it is shared by all controllers of the process
+    inline static int mpiBufferSize = 0;
+    inline static char* mpiBuffer = nullptr;
+    inline static int nBufferUsers = 0;
+    bool usesBuffer = false;
 
-    unsigned long cout;
-    FILE* file;
+    MPI_Request metricsRequests[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+    double metricsMin[1]{};
+    double metricsSum[3 + 4 * nMutationOperators]{};
+    double globalMetricsMin[1]{};
+    double globalMetricsSum[3 + 4 * nMutationOperators]{};
 
+    MPI_Request stopRequest = MPI_REQUEST_NULL;
+    int stopFlags[2]{};
+    int globalStopFlags[2]{};
+
+public:
     /**
-    * @brief print the path with the specified generation, route length and path order (non-root processes just return)
+    * @brief create a controller for the processes in the communicator, MPI has to be initialized by the caller
     */
-    void printPathToFile(unsigned long generation, double routeLength, unsigned long* order);
+    explicit MPIController(MPI_Comm comm_);
 
-public:
-    MPIController(int argc, char** argv, unsigned long nMigrate_);
+    MPIController(const MPIController &) = delete;
+
+    MPIController &operator=(const MPIController &) = delete;
+
+    /**
+    * @brief complete outstanding communication and detach and delete the buffer
+    */
+    ~MPIController();
 
     [[nodiscard]] int getID() const;
 
@@ -46,10 +67,12 @@ public:
 
     [[nodiscard]] int getNTasks() const;
 
+    [[nodiscard]] MPI_Comm getComm() const;
+
     /**
-    * @brief broadcast two arrays of points with length nPoints from process 0 to all processes
+    * @brief set the route size and the number of migrating paths, (re)attaching the mpi buffer if it is too small
     */
-    void pointsBroadcast(double* xPoints, double* yPoints);
+    void setMigrationSize(unsigned long nPoints_, unsigned long nMigrate_);
 
     /**
     * @brief send a buffer containing nMigrate path orders to the left or right neighbour
@@ -67,20 +90,56 @@ public:
     void sendBufferedMessages();
 
     /**
-    * @brief print the x- and y-points to the file (non-root processes just return)
+    * @brief gather the throughput and population size of every process on all processes
+    */
+    void allgatherThroughput(double throughput, unsigned long size, double* allThroughputs, unsigned long* allSizes);
+
+    /**
+    * @brief start sending nOrders path orders to the specified process to balance the population
+    */
+    void ordersSend(unsigned long* data, unsigned long nOrders, int destination, MPI_Request* request);
+
+    /**
+    * @brief receive nOrders path orders from the specified process to balance the population
+    */
+    void ordersReceive(unsigned long* data, unsigned long nOrders, int source);
+
+    /**
+    * @brief start a non-blocking reduction of the local termination flags over all processes
+    */
+    void stopFlagsReduceStart(bool stop, bool improving);
+
+    /**
+    * @brief complete the outstanding termination reduction, return true if any process wants to stop
+    * or if no process is still improving (returns false if no reduction was started)
+    */
+    bool stopFlagsReduceFinish();
+
+    /**
+    * @brief start a non-blocking reduction of the metrics of this process to the root process, the minimum of
+    * bestRouteLength and the sums of meanRouteLength, diversity, migrationWaitTime and the mutation statistics
+    */
+    void metricsReduceStart(double bestRouteLength, double meanRouteLength, double diversity,
+                            double migrationWaitTime, const MutationStatisticsArray &mutationStatistics);
+
+    /**
+    * @brief complete the outstanding metrics reduction, return true on the root process, where the arguments are set
+    * to the minimum best route length, the means of the other metrics and the totals of the mutation statistics over
+    * the processes
     */
-    void printPointsToFile(unsigned long populationSize, unsigned long generations,
-                           double xSize, double ySize, double* xPoints, double* yPoints) const;
+    bool metricsReduceFinish(double &bestRouteLength, double &meanRouteLength, double &diversity,
+                             double &migrationWaitTime, MutationStatisticsArray &mutationStatistics);
 
     /**
-    * @brief gather the best path from all processes to the root process, which prints the best global path to file
+    * @brief gather the best path from all processes to the root process, return true on the root process,
+    * where routeLength and order are replaced by the best global path
     */
-    void printBestPathToFile(unsigned long generation, double bestRouteLength, unsigned long* bestOrder);
+    bool gatherBestPath(double &routeLength, unsigned long* order);
 
     /**
-    * @brief detach and delete buffer, close file and run MPI_Finalize()
+    * @brief replace routeLength and order by the best global path on all processes
     */
-    void finalize();
+    void allreduceBestPath(double &routeLength, unsigned long* order);
 };
 
 
@@ -6,6 +6,9 @@
 #define GATSP_MPITIMER_H
 
 
+#include <iostream>
+#include <vector>
+
 class MPITimer {
 private:
     double t1 = 0.0;
@@ -0,0 +1,54 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <iostream>
+#include <cmath>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedMatrix.h"
+
+MappedMatrix::MappedMatrix(const std::string &fileName_) : fileName(fileName_) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "could not open matrix file " << fileName << std::endl;
+        exit(-1);
+    }
+
+    /// the matrix is square, so the number of points follows from the file size
+    struct stat fileStat{};
+    fstat(fd, &fileStat);
+    mappedSize = fileStat.st_size;
+    nPoints = (unsigned long) std::llround(std::sqrt((double) mappedSize / sizeof(double)));
+    if (nPoints * nPoints * sizeof(double) != mappedSize || nPoints == 0) {
+        std::cerr << fileName << " does not contain a square matrix of doubles" << std::endl;
+        exit(-1);
+    }
+
+    void* mapping = mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "could not map matrix file " << fileName << std::endl;
+        exit(-1);
+    }
+    data = static_cast<const double*>(mapping);
+}
+
+MappedMatrix::~MappedMatrix() {
+    munmap(const_cast<double*>(data), mappedSize);
+}
+
+const std::string &MappedMatrix::getFileName() const {
+    return fileName;
+}
+
+unsigned long MappedMatrix::getNPoints() const {
+    return nPoints;
+}
+
+const double* MappedMatrix::getData() const {
+    return data;
+}
@@ -0,0 +1,40 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_MAPPEDMATRIX_H
+#define GATSP_MAPPEDMATRIX_H
+
+
+#include <string>
+
+/**
+ * @brief read-only memory mapping of a binary file with an n x n row-major matrix of doubles
+ *
+ * The file is mapped shared, so all processes on a node that map the same file use the same pages of the page cache.
+ */
+class MappedMatrix {
+private:
+    std::string fileName;
+    const double* data = nullptr;
+    size_t mappedSize = 0;
+    unsigned long nPoints = 0;
+
+public:
+    explicit MappedMatrix(const std::string &fileName_);
+
+    MappedMatrix(const MappedMatrix &) = delete;
+
+    MappedMatrix &operator=(const MappedMatrix &) = delete;
+
+    ~MappedMatrix();
+
+    [[nodiscard]] const std::string &getFileName() const;
+
+    [[nodiscard]] unsigned long getNPoints() const;
+
+    [[nodiscard]] const double* getData() const;
+};
+
+
+#endif //GATSP_MAPPEDMATRIX_H
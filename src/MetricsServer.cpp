@@ -0,0 +1,142 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <iostream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "MetricsServer.h"
+
+#define TSP_METRICS_POLL_TIMEOUT 200                    // milliseconds between checks whether the server is stopped
+
+MetricsServer::MetricsServer(const std::string &address_) : address(address_) {
+    bool isUnixSocket = !address.empty() && address[0] == '/';
+    int rc;
+
+    if (isUnixSocket) {
+        sockaddr_un socketAddress{};
+        if (address.size() >= sizeof(socketAddress.sun_path)) {
+            std::cerr << "metrics socket path " << address << " is too long" << std::endl;
+            exit(-1);
+        }
+        socketAddress.sun_family = AF_UNIX;
+        address.copy(socketAddress.sun_path, address.size());
+
+        /// remove the socket of a previous run
+        unlink(address.c_str());
+        serverSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        rc = bind(serverSocket, (sockaddr*) &socketAddress, sizeof(socketAddress));
+    } else {
+        sockaddr_in socketAddress{};
+        socketAddress.sin_family = AF_INET;
+        socketAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socketAddress.sin_port = htons((uint16_t) strtoul(address.c_str(), nullptr, 10));
+
+        int reuse = 1;
+        serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+        setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        rc = bind(serverSocket, (sockaddr*) &socketAddress, sizeof(socketAddress));
+    }
+
+    if (serverSocket < 0 || rc != 0 || listen(serverSocket, 8) != 0) {
+        std::cerr << "could not serve the metrics on " << address << std::endl;
+        exit(-1);
+    }
+
+    thread = std::thread(&MetricsServer::serve, this);
+}
+
+MetricsServer::~MetricsServer() {
+    running = false;
+    thread.join();
+
+    close(serverSocket);
+    if (!address.empty() && address[0] == '/') unlink(address.c_str());
+}
+
+void MetricsServer::update(const TSPMetrics &metrics, const std::string &instanceName) {
+    /// escape the label value as required by the text format
+    std::string label = "{instance=\"";
+    for (auto &c : instanceName) {
+        if (c == '\\' || c == '"') label += '\\';
+        label += c == '\n' ? std::string("\\n") : std::string(1, c);
+    }
+    label += "\"}";
+
+    std::string newText;
+    char value[32];
+    auto addGauge = [&newText, &label, &value](const char* name, const char* help, double gauge) {
+        snprintf(value, sizeof(value), " %.17g\n", gauge);
+        newText += std::string("# HELP ") + name + " " + help + "\n# TYPE " + name + " gauge\n" + name + label + value;
+    };
+
+    addGauge("gatsp_generation", "Generation of the metrics.", (double) metrics.generation);
+    addGauge("gatsp_processes", "Number of processes.", metrics.nTasks);
+    addGauge("gatsp_best_route_length", "Shortest route length over all processes.", metrics.bestRouteLength);
+    addGauge("gatsp_mean_route_length", "Mean route length of the populations.", metrics.meanRouteLength);
+    addGauge("gatsp_generations_per_second", "Generations per second since the previous report.",
+             metrics.generationsPerSecond);
+    addGauge("gatsp_migration_wait_seconds", "Mean time per process waiting for immigrants in this run.",
+             metrics.migrationWaitTime);
+    addGauge("gatsp_diversity", "Mean fraction of distinct route lengths in the populations.", metrics.diversity);
+
+    /// one sample per mutation operator, labelled with the operator name
+    auto addOperatorCounter = [&newText, &label, &value, &metrics](const char* name, const char* help,
+                                                                  double MutationStatistics::* counter) {
+        newText += std::string("# HELP ") + name + " " + help + "\n# TYPE " + name + " counter\n";
+        for (unsigned long i = 0; i < nMutationOperators; i++) {
+            snprintf(value, sizeof(value), " %.17g\n", metrics.mutationStatistics[i].*counter);
+            newText += name + label.substr(0, label.size() - 1) + ",operator=\"" +
+                       getMutationOperatorName((MutationOperator) i) + "\"}" + value;
+        }
+    };
+
+    addOperatorCounter("gatsp_mutations_total", "Mutations applied in this run.", &MutationStatistics::nApplied);
+    addOperatorCounter("gatsp_mutations_improved_total", "Mutations that shortened the route in this run.",
+                       &MutationStatistics::nImproved);
+    addOperatorCounter("gatsp_mutation_improvement_total", "Sum of the route length decreases by mutations.",
+                       &MutationStatistics::improvement);
+    addOperatorCounter("gatsp_mutation_seconds_total", "Estimated time spent in mutations in this run.",
+                       &MutationStatistics::time);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    text.swap(newText);
+}
+
+void MetricsServer::serve() {
+    while (running) {
+        pollfd serverPoll{serverSocket, POLLIN, 0};
+        if (poll(&serverPoll, 1, TSP_METRICS_POLL_TIMEOUT) <= 0) continue;
+
+        int client = accept(serverSocket, nullptr, nullptr);
+        if (client < 0) continue;
+
+        /// read and ignore the request, every path returns the metrics
+        timeval timeout{1, 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        char request[4096];
+        if (recv(client, request, sizeof(request), 0) < 0) {
+            close(client);
+            continue;
+        }
+
+        std::string body;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            body = text;
+        }
+        std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+
+        for (size_t sent = 0; sent < response.size();) {
+            ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            sent += n;
+        }
+        close(client);
+    }
+}
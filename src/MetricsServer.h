@@ -0,0 +1,59 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_METRICSSERVER_H
+#define GATSP_METRICSSERVER_H
+
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "TravellingSalesman.h"
+
+/**
+ * @brief serve the latest metrics of a run in the Prometheus text format over HTTP
+ *
+ * The metrics are formatted by update on the calling thread and served by a background thread, which only copies the
+ * formatted text under a mutex, so the genetic algorithm never waits for a client. The background thread makes no MPI
+ * calls, so MPI_THREAD_FUNNELED is sufficient. The address is either a TCP port, which is bound to localhost only, or
+ * the path of a Unix socket (starting with '/'), e.g. for curl --unix-socket.
+ */
+class MetricsServer {
+private:
+    std::string address;
+    int serverSocket = -1;
+
+    std::mutex mutex;
+    std::string text;
+
+    std::atomic<bool> running{true};
+    std::thread thread;
+
+    /**
+     * @brief answer every request with the metrics until the server is stopped
+     */
+    void serve();
+
+public:
+    explicit MetricsServer(const std::string &address_);
+
+    MetricsServer(const MetricsServer &) = delete;
+
+    MetricsServer &operator=(const MetricsServer &) = delete;
+
+    /**
+     * @brief stop and join the background thread and close the socket
+     */
+    ~MetricsServer();
+
+    /**
+     * @brief replace the served metrics, the instance name is added as a label
+     */
+    void update(const TSPMetrics &metrics, const std::string &instanceName);
+};
+
+
+#endif //GATSP_METRICSSERVER_H
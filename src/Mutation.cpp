@@ -0,0 +1,91 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "Mutation.h"
+
+#define TSP_MUTATION_DISCOUNT 0.999                     // weight of the past per mutation, ~1000 mutations memory
+#define TSP_MUTATION_EXPLORATION 1.0                    // weight of the exploration term of the bandit
+
+const char* getMutationOperatorName(MutationOperator mutationOperator) {
+    switch (mutationOperator) {
+        case MutationOperator::swap:
+            return "swap";
+        case MutationOperator::inversion:
+            return "inversion";
+        case MutationOperator::insertion:
+            return "insertion";
+        case MutationOperator::scramble:
+            return "scramble";
+        case MutationOperator::doubleBridge:
+            return "double_bridge";
+    }
+    return "";
+}
+
+Mutation::Mutation(bool adaptive, const MutationCostArray &costs) : adaptive(adaptive), costs(costs) {}
+
+MutationOperator Mutation::select() const {
+    if (!adaptive) return MutationOperator::swap;
+
+    /// try the operators that have (almost) no weight left first
+    for (unsigned long i = 0; i < nMutationOperators; i++) {
+        if (discounted[i].nApplied < 1.0) return (MutationOperator) i;
+    }
+
+    /// the reward is the improvement per time, scaled by the best operator so the exploration term is comparable
+    std::array<double, nMutationOperators> rewards{};
+    double maxReward = 0.0;
+    for (unsigned long i = 0; i < nMutationOperators; i++) {
+        rewards[i] = discounted[i].time > 0.0 ? discounted[i].improvement / discounted[i].time : 0.0;
+        maxReward = std::max(maxReward, rewards[i]);
+    }
+
+    unsigned long best = 0;
+    double bestScore = -1.0;
+    double logN = std::log(nDiscounted);
+    for (unsigned long i = 0; i < nMutationOperators; i++) {
+        double score = (maxReward > 0.0 ? rewards[i] / maxReward : 0.0) +
+                       TSP_MUTATION_EXPLORATION * std::sqrt(2.0 * logN / discounted[i].nApplied);
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return (MutationOperator) best;
+}
+
+void Mutation::update(MutationOperator mutationOperator, double improvement) {
+    auto i = (unsigned long) mutationOperator;
+    double time = costs[i];
+    statistics[i].nApplied += 1.0;
+    statistics[i].time += time;
+    if (improvement > 0.0) {
+        statistics[i].nImproved += 1.0;
+        statistics[i].improvement += improvement;
+    }
+    if (!adaptive) return;
+
+    /// discount the bandit statistics of all operators before adding the new mutation
+    for (auto &arm : discounted) {
+        arm.nApplied *= TSP_MUTATION_DISCOUNT;
+        arm.nImproved *= TSP_MUTATION_DISCOUNT;
+        arm.improvement *= TSP_MUTATION_DISCOUNT;
+        arm.time *= TSP_MUTATION_DISCOUNT;
+    }
+    nDiscounted = nDiscounted * TSP_MUTATION_DISCOUNT + 1.0;
+
+    discounted[i].nApplied += 1.0;
+    discounted[i].time += time;
+    if (improvement > 0.0) {
+        discounted[i].nImproved += 1.0;
+        discounted[i].improvement += improvement;
+    }
+}
+
+const MutationStatisticsArray &Mutation::getStatistics() const {
+    return statistics;
+}
@@ -0,0 +1,82 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_MUTATION_H
+#define GATSP_MUTATION_H
+
+
+#include <array>
+
+enum class MutationOperator {
+    swap,
+    inversion,
+    insertion,
+    scramble,
+    doubleBridge,
+};
+
+constexpr unsigned long nMutationOperators = 5;
+
+/**
+ * @brief return the name of the operator, as used in the metrics
+ */
+const char* getMutationOperatorName(MutationOperator mutationOperator);
+
+/**
+ * @brief totals of the applications of a mutation operator, in doubles so they can be reduced with the other metrics
+ */
+struct MutationStatistics {
+    double nApplied = 0.0;
+    double nImproved = 0.0;
+
+    /// sum of the decreases of the route length by the mutations that made the route shorter
+    double improvement = 0.0;
+
+    /// time spent in the mutations in seconds, estimated by the cost per mutation of the operator
+    double time = 0.0;
+};
+
+using MutationStatisticsArray = std::array<MutationStatistics, nMutationOperators>;
+
+/// mean time in seconds of a mutation by every operator
+using MutationCostArray = std::array<double, nMutationOperators>;
+
+/**
+ * @brief selects the mutation operator of every child, one selector per island
+ *
+ * The adaptive selector is a multi-armed bandit (UCB1) where the reward of an operator is its improvement of the route
+ * length per nanosecond. The statistics of the bandit are discounted, so it follows the operators that pay off in the
+ * current stage of the run. Without adaptation every child gets a random swap.
+ *
+ * A single mutation takes about as long as reading the clock, so the mutations are not timed one by one: every
+ * mutation is charged the cost of its operator, measured once per run over a batch of mutations.
+ */
+class Mutation {
+private:
+    bool adaptive;
+    MutationCostArray costs;
+
+    /// discounted totals of the bandit and the totals since the start of the run
+    MutationStatisticsArray discounted{};
+    MutationStatisticsArray statistics{};
+    double nDiscounted = 0.0;
+
+public:
+    Mutation(bool adaptive, const MutationCostArray &costs);
+
+    /**
+     * @brief return the operator for the next child, every operator is tried once before the bandit takes over
+     */
+    MutationOperator select() const;
+
+    /**
+     * @brief add the decrease of the route length and the cost of a mutation by the operator
+     */
+    void update(MutationOperator mutationOperator, double improvement);
+
+    [[nodiscard]] const MutationStatisticsArray &getStatistics() const;
+};
+
+
+#endif //GATSP_MUTATION_H
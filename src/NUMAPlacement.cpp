@@ -0,0 +1,143 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <sched.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "NUMAPlacement.h"
+
+#define TSP_NUMA_NODE_DIRECTORY "/sys/devices/system/node"
+
+NUMAPlacement::NUMAPlacement(MPI_Comm comm) {
+    /// read the cpus of every NUMA node, in the order of their ids
+    std::error_code error;
+    for (auto &entry : std::filesystem::directory_iterator(TSP_NUMA_NODE_DIRECTORY, error)) {
+        std::string name = entry.path().filename().string();
+        if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+            name.find_first_not_of("0123456789", 4) != std::string::npos) {
+            continue;
+        }
+
+        std::ifstream cpuListFile(entry.path() / "cpulist");
+        std::string cpuList;
+        std::getline(cpuListFile, cpuList);
+        NUMANode node{std::stoul(name.substr(4)), parseCPUList(cpuList)};
+        if (!node.cpus.empty()) numaNodes.push_back(node);
+    }
+    std::sort(numaNodes.begin(), numaNodes.end(), [](const NUMANode &a, const NUMANode &b) { return a.id < b.id; });
+
+    /// without a NUMA topology, all online cpus form one node
+    if (numaNodes.empty()) {
+        numaNodes.emplace_back();
+        for (int cpu = 0; cpu < (int) sysconf(_SC_NPROCESSORS_ONLN); cpu++) numaNodes[0].cpus.push_back(cpu);
+    }
+
+    /// find the rank of this process between the processes on the same node
+    MPI_Comm nodeComm;
+    int id, nodeID, nNodeTasks, nameLength;
+    MPI_Comm_rank(comm, &id);
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, id, MPI_INFO_NULL, &nodeComm);
+    MPI_Comm_rank(nodeComm, &nodeID);
+    MPI_Comm_size(nodeComm, &nNodeTasks);
+    MPI_Comm_free(&nodeComm);
+    nodeLeader = nodeID == 0;
+
+    char name[MPI_MAX_PROCESSOR_NAME]{};
+    MPI_Get_processor_name(name, &nameLength);
+    nodeName = name;
+
+    /// divide the processes in blocks over the NUMA nodes, the first block of the NUMA node starts at the first
+    /// process with (process * nNUMANodes / nNodeTasks) equal to the NUMA node
+    unsigned long nNUMANodes = numaNodes.size();
+    auto numaIndex = (unsigned long) nodeID * nNUMANodes / (unsigned long) nNodeTasks;
+    auto getFirstTask = [nNUMANodes, nNodeTasks](unsigned long index) {
+        return (index * (unsigned long) nNodeTasks + nNUMANodes - 1) / nNUMANodes;
+    };
+    unsigned long indexInNode = (unsigned long) nodeID - getFirstTask(numaIndex);
+    unsigned long nNUMATasks = getFirstTask(numaIndex + 1) - getFirstTask(numaIndex);
+
+    /// give every process an equal share of the cores of its NUMA node, or one core if there are too few
+    const auto &numaCPUs = numaNodes[numaIndex].cpus;
+    numaNode = numaNodes[numaIndex].id;
+    unsigned long nCPUs = numaCPUs.size();
+    if (nNUMATasks <= nCPUs) {
+        cpus.assign(numaCPUs.begin() + (long) (indexInNode * nCPUs / nNUMATasks),
+                    numaCPUs.begin() + (long) ((indexInNode + 1) * nCPUs / nNUMATasks));
+    } else {
+        cpus.push_back(numaCPUs[indexInNode % nCPUs]);
+    }
+}
+
+std::vector<int> NUMAPlacement::parseCPUList(const std::string &cpuList) {
+    std::vector<int> cpus;
+    const char* position = cpuList.c_str();
+    char* end;
+    while (*position != '\0') {
+        int first = (int) strtol(position, &end, 10);
+        if (end == position) break;
+        int last = first;
+        if (*end == '-') {
+            position = end + 1;
+            last = (int) strtol(position, &end, 10);
+        }
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        position = *end == ',' ? end + 1 : end;
+    }
+    return cpus;
+}
+
+NUMAPlacement::NUMACounters NUMAPlacement::readCounters(unsigned long id) const {
+    static const char* names[] = {"numa_hit", "numa_miss", "local_node", "other_node"};
+
+    NUMACounters counters{};
+    std::ifstream file(TSP_NUMA_NODE_DIRECTORY "/node" + std::to_string(id) + "/numastat");
+    std::string name;
+    unsigned long value;
+    while (file >> name >> value) {
+        for (unsigned long i = 0; i < counters.size(); i++) {
+            if (name == names[i]) counters[i] = value;
+        }
+    }
+    return counters;
+}
+
+void NUMAPlacement::pin() const {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (auto &cpu : cpus) CPU_SET(cpu, &cpuSet);
+
+    /// a failed pin only costs performance, so the run continues
+    if (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) != 0) {
+        std::cerr << "could not pin the process to numa node " << numaNode << " on " << nodeName << ": "
+                  << strerror(errno) << std::endl;
+    }
+}
+
+void NUMAPlacement::startCounters() {
+    /// without numastat files there is nothing to count
+    initialCounters.clear();
+    std::string numastat = TSP_NUMA_NODE_DIRECTORY "/node" + std::to_string(numaNodes[0].id) + "/numastat";
+    if (!std::filesystem::exists(numastat)) return;
+
+    for (auto &node : numaNodes) initialCounters.push_back(readCounters(node.id));
+}
+
+void NUMAPlacement::printCounters() const {
+    if (!nodeLeader || initialCounters.size() != numaNodes.size()) return;
+
+    /// the counters count pages, allocated on the NUMA node by processes on the same (local) or another node
+    for (unsigned long i = 0; i < numaNodes.size(); i++) {
+        NUMACounters counters = readCounters(numaNodes[i].id);
+        printf("%s numa node %lu: %lu page allocations, %lu local, %lu from other nodes, %lu misses\n",
+               nodeName.c_str(), numaNodes[i].id, counters[0] - initialCounters[i][0],
+               counters[2] - initialCounters[i][2], counters[3] - initialCounters[i][3],
+               counters[1] - initialCounters[i][1]);
+    }
+}
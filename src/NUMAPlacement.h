@@ -0,0 +1,72 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_NUMAPLACEMENT_H
+#define GATSP_NUMAPLACEMENT_H
+
+
+#include <mpi.h>
+#include <array>
+#include <string>
+#include <vector>
+
+/**
+ * @brief NUMA topology of the node, read from /sys/devices/system/node, and the cores of this process
+ *
+ * The processes on a node are divided in blocks over the NUMA nodes, so neighbouring processes (which exchange
+ * migrants) share a NUMA node, and every process gets an equal share of the cores of its NUMA node. Memory is placed
+ * on the NUMA node of the thread that first touches it, so a pinned process allocates its populations locally if it is
+ * pinned before they are created. Without /sys (or on a machine with one NUMA node) pinning is still by core.
+ */
+class NUMAPlacement {
+private:
+    struct NUMANode {
+        unsigned long id = 0;
+        std::vector<int> cpus;
+    };
+
+    /// numa_hit, numa_miss, local_node and other_node of every NUMA node
+    using NUMACounters = std::array<unsigned long, 4>;
+
+    std::vector<NUMANode> numaNodes;
+    std::vector<NUMACounters> initialCounters;
+    unsigned long numaNode = 0;
+    std::vector<int> cpus;
+    bool nodeLeader = false;
+    std::string nodeName;
+
+    /**
+    * @brief return the cpus of a list in the format of /sys, e.g. 0-3,8-11
+    */
+    static std::vector<int> parseCPUList(const std::string &cpuList);
+
+    /**
+    * @brief return the page allocation counters of the NUMA node, read from its numastat file
+    */
+    [[nodiscard]] NUMACounters readCounters(unsigned long id) const;
+
+public:
+    /**
+    * @brief read the topology and assign the cores of this process, collective over the communicator
+    */
+    explicit NUMAPlacement(MPI_Comm comm);
+
+    /**
+    * @brief restrict this process, and the threads it creates afterwards, to its cores
+    */
+    void pin() const;
+
+    /**
+    * @brief remember the page allocation counters of all NUMA nodes of the node
+    */
+    void startCounters();
+
+    /**
+    * @brief print the page allocations of every NUMA node since startCounters, once per node
+    */
+    void printCounters() const;
+};
+
+
+#endif //GATSP_NUMAPLACEMENT_H
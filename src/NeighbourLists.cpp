@@ -0,0 +1,69 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <algorithm>
+#include <limits>
+
+#include "NeighbourLists.h"
+#include "TSPInstance.h"
+
+void NeighbourLists::build(const TSPInstance &instance, unsigned long k_, MPI_Comm comm) {
+    int id, nTasks;
+    MPI_Comm_rank(comm, &id);
+    MPI_Comm_size(comm, &nTasks);
+
+    nPoints = instance.nPoints;
+    k = std::min(k_, nPoints - 1);
+    neighbours.resize(nPoints * k);
+
+    /// compute the lists of the points of this process
+    unsigned long first = nPoints * id / nTasks;
+    unsigned long last = nPoints * (id + 1) / nTasks;
+    withMetric(instance.metric, instance.xPoints, instance.yPoints, instance.matrix, nPoints,
+               [this, first, last](const auto &metric) { setNeighbours(metric, first, last); });
+
+    /// gather the lists of all processes
+    std::vector<int> counts(nTasks), displacements(nTasks);
+    for (int i = 0; i < nTasks; i++) {
+        displacements[i] = (int) (k * (nPoints * i / nTasks));
+        counts[i] = (int) (k * (nPoints * (i + 1) / nTasks)) - displacements[i];
+    }
+    MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+                   neighbours.data(), counts.data(), displacements.data(), MPI_UNSIGNED_LONG, comm);
+}
+
+template<class Metric>
+void NeighbourLists::setNeighbours(const Metric &metric, unsigned long first, unsigned long last) {
+    std::vector<double> distances(k);
+
+    for (unsigned long i = first; i < last; i++) {
+        unsigned long* list = &neighbours[i * k];
+        unsigned long nFound = 0;
+
+        /// keep the k nearest points found so far sorted, inserting a point only if it is closer than the last
+        for (unsigned long j = 0; j < nPoints; j++) {
+            if (j == i) continue;
+
+            double distance = metric.compare(i, j);
+            if (nFound == k && distance >= distances[k - 1]) continue;
+
+            unsigned long position = nFound < k ? nFound++ : k - 1;
+            while (position > 0 && distances[position - 1] > distance) {
+                distances[position] = distances[position - 1];
+                list[position] = list[position - 1];
+                position--;
+            }
+            distances[position] = distance;
+            list[position] = j;
+        }
+    }
+}
+
+unsigned long NeighbourLists::getK() const {
+    return k;
+}
+
+const unsigned long* NeighbourLists::getNeighbours(unsigned long i) const {
+    return &neighbours[i * k];
+}
@@ -0,0 +1,42 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_NEIGHBOURLISTS_H
+#define GATSP_NEIGHBOURLISTS_H
+
+
+#include <mpi.h>
+#include <vector>
+
+struct TSPInstance;
+
+/**
+ * @brief the k nearest neighbours of every point, sorted from near to far
+ */
+class NeighbourLists {
+private:
+    unsigned long nPoints = 0;
+    unsigned long k = 0;
+    std::vector<unsigned long> neighbours;
+
+    template<class Metric>
+    void setNeighbours(const Metric &metric, unsigned long first, unsigned long last);
+
+public:
+    /**
+     * @brief find the k nearest neighbours of every point, every process of the communicator computes the lists of
+     * a range of points, which are then gathered on all processes
+     */
+    void build(const TSPInstance &instance, unsigned long k_, MPI_Comm comm);
+
+    [[nodiscard]] unsigned long getK() const;
+
+    /**
+     * @brief return the k nearest neighbours of point i
+     */
+    [[nodiscard]] const unsigned long* getNeighbours(unsigned long i) const;
+};
+
+
+#endif //GATSP_NEIGHBOURLISTS_H
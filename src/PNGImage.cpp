@@ -0,0 +1,208 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <iostream>
+#include <fstream>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+
+#include "PNGImage.h"
+
+namespace {
+
+    /**
+     * @brief writes bits to a byte array starting at the least significant bit, as deflate requires
+     */
+    class BitWriter {
+    private:
+        std::vector<unsigned char> &data;
+        uint32_t bitBuffer = 0;
+        int nBits = 0;
+
+    public:
+        explicit BitWriter(std::vector<unsigned char> &data_) : data(data_) {}
+
+        void writeBits(uint32_t value, int n) {
+            bitBuffer |= value << nBits;
+            nBits += n;
+            while (nBits >= 8) {
+                data.push_back((unsigned char) (bitBuffer & 0xff));
+                bitBuffer >>= 8;
+                nBits -= 8;
+            }
+        }
+
+        /// Huffman codes are stored starting at their most significant bit
+        void writeCode(uint32_t code, int n) {
+            uint32_t reversed = 0;
+            for (int i = 0; i < n; i++) reversed |= ((code >> i) & 1) << (n - 1 - i);
+            writeBits(reversed, n);
+        }
+
+        void flush() {
+            if (nBits > 0) data.push_back((unsigned char) (bitBuffer & 0xff));
+            bitBuffer = 0;
+            nBits = 0;
+        }
+    };
+
+    /// write a literal/length symbol with the fixed Huffman code
+    void writeSymbol(BitWriter &bitWriter, unsigned symbol) {
+        if (symbol < 144) {
+            bitWriter.writeCode(0x30 + symbol, 8);
+        } else if (symbol < 256) {
+            bitWriter.writeCode(0x190 + symbol - 144, 9);
+        } else if (symbol < 280) {
+            bitWriter.writeCode(symbol - 256, 7);
+        } else {
+            bitWriter.writeCode(0xc0 + symbol - 280, 8);
+        }
+    }
+
+    /// write a match of 3 to 258 bytes at distance 1 (a run of the previous byte)
+    void writeRun(BitWriter &bitWriter, unsigned length) {
+        static const unsigned lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                                35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const int lengthExtraBits[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                                3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        int code = 28;
+        while (lengthBase[code] > length) code--;
+
+        writeSymbol(bitWriter, 257 + code);
+        bitWriter.writeBits(length - lengthBase[code], lengthExtraBits[code]);
+
+        /// distance code 0 (distance 1) with 5 bits and no extra bits
+        bitWriter.writeCode(0, 5);
+    }
+
+    uint32_t getCRC(const unsigned char* data, unsigned long size, uint32_t crc = 0) {
+        static const auto table = [] {
+            std::array<uint32_t, 256> crcTable{};
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+                crcTable[i] = c;
+            }
+            return crcTable;
+        }();
+
+        crc = ~crc;
+        for (unsigned long i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    void appendBigEndian(std::vector<unsigned char> &data, uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) data.push_back((unsigned char) ((value >> shift) & 0xff));
+    }
+
+    /// append a chunk with its length, type, data and CRC
+    void appendChunk(std::vector<unsigned char> &file, const char* type, const std::vector<unsigned char> &data) {
+        appendBigEndian(file, (uint32_t) data.size());
+        unsigned long typeStart = file.size();
+        file.insert(file.end(), type, type + 4);
+        file.insert(file.end(), data.begin(), data.end());
+        appendBigEndian(file, getCRC(&file[typeStart], file.size() - typeStart));
+    }
+}
+
+PNGImage::PNGImage(unsigned long width_, unsigned long height_)
+        : width(width_), height(height_), pixels(width_ * height_, Colour::white) {}
+
+void PNGImage::setPixel(long x, long y, Colour colour) {
+    if (x < 0 || y < 0 || x >= (long) width || y >= (long) height) return;
+    pixels[y * width + x] = colour;
+}
+
+void PNGImage::drawPoint(long x, long y, long radius, Colour colour) {
+    for (long dy = -radius; dy <= radius; dy++) {
+        for (long dx = -radius; dx <= radius; dx++) {
+            setPixel(x + dx, y + dy, colour);
+        }
+    }
+}
+
+void PNGImage::drawLine(long x0, long y0, long x1, long y1, Colour colour) {
+    long dx = std::abs(x1 - x0), dy = -std::abs(y1 - y0);
+    long sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+    long error = dx + dy;
+    while (true) {
+        setPixel(x0, y0, colour);
+        if (x0 == x1 && y0 == y1) break;
+
+        long error2 = 2 * error;
+        if (error2 >= dy) {
+            error += dy;
+            x0 += sx;
+        }
+        if (error2 <= dx) {
+            error += dx;
+            y0 += sy;
+        }
+    }
+}
+
+std::vector<unsigned char> PNGImage::getCompressedData() const {
+    /// every row starts with filter type 0 (none)
+    std::vector<unsigned char> rows;
+    rows.reserve(height * (width + 1));
+    for (unsigned long y = 0; y < height; y++) {
+        rows.push_back(0);
+        rows.insert(rows.end(), &pixels[y * width], &pixels[0] + (y + 1) * width);
+    }
+
+    /// zlib header (deflate, 32K window, fastest) and a single fixed Huffman block
+    std::vector<unsigned char> data = {0x78, 0x01};
+    BitWriter bitWriter(data);
+    bitWriter.writeBits(1, 1);
+    bitWriter.writeBits(1, 2);
+
+    for (unsigned long i = 0; i < rows.size();) {
+        unsigned run = 0;
+        while (i > 0 && run < 258 && i + run < rows.size() && rows[i + run] == rows[i - 1]) run++;
+
+        if (run >= 3) {
+            writeRun(bitWriter, run);
+            i += run;
+        } else {
+            writeSymbol(bitWriter, rows[i]);
+            i++;
+        }
+    }
+    writeSymbol(bitWriter, 256);
+    bitWriter.flush();
+
+    /// Adler-32 checksum of the uncompressed data
+    uint32_t a = 1, b = 0;
+    for (auto &byte : rows) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    appendBigEndian(data, (b << 16) | a);
+
+    return data;
+}
+
+void PNGImage::write(const std::string &fileName) const {
+    std::vector<unsigned char> file = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+    /// 8-bit palette image
+    std::vector<unsigned char> header;
+    appendBigEndian(header, (uint32_t) width);
+    appendBigEndian(header, (uint32_t) height);
+    header.insert(header.end(), {8, 3, 0, 0, 0});
+    appendChunk(file, "IHDR", header);
+
+    std::vector<unsigned char> palette = {255, 255, 255, 0, 0, 0, 220, 30, 30, 160, 160, 160};
+    appendChunk(file, "PLTE", palette);
+    appendChunk(file, "IDAT", getCompressedData());
+    appendChunk(file, "IEND", {});
+
+    std::ofstream output(fileName, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "could not open output file " << fileName << std::endl;
+        exit(-1);
+    }
+    output.write((const char*) file.data(), (long) file.size());
+}
@@ -0,0 +1,64 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_PNGIMAGE_H
+#define GATSP_PNGIMAGE_H
+
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief palette image that is written as a PNG file without external libraries
+ *
+ * The pixel data is compressed with deflate using the fixed Huffman codes and runs of the previous byte only, which
+ * is fast and compresses the mostly blank frames of a route well.
+ */
+class PNGImage {
+private:
+    unsigned long width;
+    unsigned long height;
+    std::vector<unsigned char> pixels;
+
+    /**
+     * @brief return the zlib stream of the filtered pixel rows
+     */
+    [[nodiscard]] std::vector<unsigned char> getCompressedData() const;
+
+public:
+    enum Colour : unsigned char {
+        white,
+        black,
+        red,
+        grey,
+    };
+
+    /**
+     * @brief create a white image
+     */
+    PNGImage(unsigned long width_, unsigned long height_);
+
+    /**
+     * @brief set the pixel, pixels outside the image are ignored
+     */
+    void setPixel(long x, long y, Colour colour);
+
+    /**
+     * @brief draw a square point of (2 * radius + 1) pixels wide
+     */
+    void drawPoint(long x, long y, long radius, Colour colour);
+
+    /**
+     * @brief draw a line with Bresenham's algorithm
+     */
+    void drawLine(long x0, long y0, long x1, long y1, Colour colour);
+
+    /**
+     * @brief write the image to a PNG file
+     */
+    void write(const std::string &fileName) const;
+};
+
+
+#endif //GATSP_PNGIMAGE_H
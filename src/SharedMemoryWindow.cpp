@@ -0,0 +1,58 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <algorithm>
+#include <climits>
+
+#include "SharedMemoryWindow.h"
+
+SharedMemoryWindow::SharedMemoryWindow(MPI_Comm comm, int root, unsigned long size_) : size(size_) {
+    int id;
+    MPI_Comm_rank(comm, &id);
+
+    /// split the processes per node, making the root process the leader of its node
+    int key = id == root ? 0 : id + 1;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, key, MPI_INFO_NULL, &nodeComm);
+
+    int nodeID;
+    MPI_Comm_rank(nodeComm, &nodeID);
+    leader = nodeID == 0;
+    MPI_Comm_split(comm, leader ? 0 : MPI_UNDEFINED, key, &leaderComm);
+
+    /// only the node leader allocates memory, the other processes query its address
+    MPI_Aint localSize = leader ? (MPI_Aint) (size * sizeof(double)) : 0;
+    MPI_Win_allocate_shared(localSize, sizeof(double), MPI_INFO_NULL, nodeComm, &data, &window);
+    if (!leader) {
+        MPI_Aint leaderSize;
+        int displacementUnit;
+        MPI_Win_shared_query(window, 0, &leaderSize, &displacementUnit, &data);
+    }
+}
+
+SharedMemoryWindow::~SharedMemoryWindow() {
+    MPI_Win_free(&window);
+    if (leaderComm != MPI_COMM_NULL) MPI_Comm_free(&leaderComm);
+    MPI_Comm_free(&nodeComm);
+}
+
+double* SharedMemoryWindow::getData() const {
+    return data;
+}
+
+bool SharedMemoryWindow::isLeader() const {
+    return leader;
+}
+
+void SharedMemoryWindow::broadcastBetweenLeaders() {
+    /// broadcast in chunks, as the count of MPI_Bcast is an int
+    const unsigned long chunkSize = INT_MAX / 2;
+    for (unsigned long offset = 0; offset < size; offset += chunkSize) {
+        int count = (int) std::min(chunkSize, size - offset);
+        MPI_Bcast(&data[offset], count, MPI_DOUBLE, 0, leaderComm);
+    }
+}
+
+void SharedMemoryWindow::synchronize() {
+    MPI_Win_fence(0, window);
+}
@@ -0,0 +1,56 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_SHAREDMEMORYWINDOW_H
+#define GATSP_SHAREDMEMORYWINDOW_H
+
+
+#include <mpi.h>
+
+/**
+ * @brief an array of doubles allocated once per node with MPI_Win_allocate_shared
+ *
+ * The processes of the communicator are split into one communicator per node. The node leader allocates the array,
+ * all other processes on the node access it directly. The root process is always the leader of its node, and the
+ * node leaders form a communicator (with the root process as rank 0) to fill the arrays of all nodes.
+ * Constructing and destructing the window is collective over the communicator.
+ */
+class SharedMemoryWindow {
+private:
+    MPI_Comm nodeComm = MPI_COMM_NULL;
+    MPI_Comm leaderComm = MPI_COMM_NULL;
+    MPI_Win window = MPI_WIN_NULL;
+    double* data = nullptr;
+    unsigned long size;
+    bool leader;
+
+public:
+    SharedMemoryWindow(MPI_Comm comm, int root, unsigned long size_);
+
+    SharedMemoryWindow(const SharedMemoryWindow &) = delete;
+
+    SharedMemoryWindow &operator=(const SharedMemoryWindow &) = delete;
+
+    ~SharedMemoryWindow();
+
+    /**
+    * @brief return the node-local array, only the node leader may write to it before synchronize is called
+    */
+    [[nodiscard]] double* getData() const;
+
+    [[nodiscard]] bool isLeader() const;
+
+    /**
+    * @brief broadcast the array of the root process to the node leaders (node leaders only)
+    */
+    void broadcastBetweenLeaders();
+
+    /**
+    * @brief make the data written by the node leader visible to all processes on the node (collective on the node)
+    */
+    void synchronize();
+};
+
+
+#endif //GATSP_SHAREDMEMORYWINDOW_H
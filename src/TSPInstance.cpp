@@ -0,0 +1,182 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+#include "TSPInstance.h"
+#include "MappedMatrix.h"
+#include "SharedMemoryWindow.h"
+#include "Random.h"
+
+TSPInstance TSPInstance::fromFile(const std::string &fileName, unsigned long nPoints) {
+    std::ifstream file(fileName);
+    if (!file.is_open()) {
+        std::cerr << "could not open input file " << fileName << std::endl;
+        exit(-1);
+    }
+
+    /// xPoint is between startLine and comma and yPoint is between comma and endLine
+    std::vector<double> xPoints, yPoints;
+    std::string line;
+    while ((nPoints == 0 || xPoints.size() < nPoints) && std::getline(file, line)) {
+        size_t commaPos = line.find(',');
+        if (commaPos == std::string::npos) continue;
+
+        xPoints.push_back(strtod(line.c_str(), nullptr));
+        yPoints.push_back(strtod(line.c_str() + commaPos + 1, nullptr));
+    }
+
+    if (xPoints.size() < nPoints) {
+        std::cerr << fileName << " contains " << xPoints.size() << " points, expected " << nPoints << std::endl;
+        exit(-1);
+    }
+
+    TSPInstance instance = fromPoints(xPoints, yPoints);
+    instance.name = fileName;
+
+    return instance;
+}
+
+TSPInstance TSPInstance::fromPoints(const std::vector<double> &xPoints, const std::vector<double> &yPoints) {
+    /// store the x-points followed by the y-points
+    auto points = std::make_shared<std::vector<double>>(xPoints);
+    points->insert(points->end(), yPoints.begin(), yPoints.end());
+
+    TSPInstance instance;
+    instance.name = "points";
+    instance.nPoints = xPoints.size();
+    instance.xSize = xPoints.empty() ? 0.0 : *std::max_element(xPoints.begin(), xPoints.end());
+    instance.ySize = yPoints.empty() ? 0.0 : *std::max_element(yPoints.begin(), yPoints.end());
+    instance.xPoints = points->data();
+    instance.yPoints = points->data() + instance.nPoints;
+    instance.storage = points;
+
+    return instance;
+}
+
+TSPInstance TSPInstance::fromMatrixFile(const std::string &fileName, bool symmetric) {
+    auto mappedMatrix = std::make_shared<const MappedMatrix>(fileName);
+
+    /// there are no coordinates, the (zero) points are only used for the output file
+    auto points = std::make_shared<std::vector<double>>(2 * mappedMatrix->getNPoints(), 0.0);
+
+    TSPInstance instance;
+    instance.name = fileName;
+    instance.metric = symmetric ? MetricType::matrix : MetricType::asymmetricMatrix;
+    instance.nPoints = mappedMatrix->getNPoints();
+    instance.xPoints = points->data();
+    instance.yPoints = points->data() + instance.nPoints;
+    instance.matrix = mappedMatrix->getData();
+    instance.storage = std::make_shared<std::pair<std::shared_ptr<const MappedMatrix>,
+                                                  std::shared_ptr<std::vector<double>>>>(mappedMatrix, points);
+
+    return instance;
+}
+
+TSPInstance TSPInstance::random(unsigned long nPoints, double xSize, double ySize) {
+    auto points = std::make_shared<std::vector<double>>(2 * nPoints);
+    for (unsigned long i = 0; i < nPoints; i++) {
+        (*points)[i] = Random::random(0, xSize);
+        (*points)[nPoints + i] = Random::random(0, ySize);
+    }
+
+    TSPInstance instance;
+    instance.name = "random";
+    instance.nPoints = nPoints;
+    instance.xSize = xSize;
+    instance.ySize = ySize;
+    instance.xPoints = points->data();
+    instance.yPoints = points->data() + nPoints;
+    instance.storage = points;
+
+    return instance;
+}
+
+TSPInstance TSPInstance::subset(const std::vector<unsigned long> &points) const {
+    std::vector<double> xSubset(points.size()), ySubset(points.size());
+    for (unsigned long i = 0; i < points.size(); i++) {
+        xSubset[i] = xPoints[points[i]];
+        ySubset[i] = yPoints[points[i]];
+    }
+
+    TSPInstance instance = fromPoints(xSubset, ySubset);
+    instance.name = name;
+    instance.metric = metric;
+
+    return instance;
+}
+
+void TSPInstance::share(std::vector<TSPInstance> &instances, MPI_Comm comm, int root) {
+    int id;
+    MPI_Comm_rank(comm, &id);
+
+    /// broadcast the description of every instance
+    unsigned long nInstances = instances.size();
+    MPI_Bcast(&nInstances, 1, MPI_UNSIGNED_LONG, root, comm);
+    instances.resize(nInstances);
+
+    std::vector<double> sizes(2 * nInstances);
+    std::vector<unsigned long> nPoints(nInstances);
+    std::vector<int> metrics(nInstances);
+    for (unsigned long i = 0; i < nInstances; i++) {
+        sizes[2 * i] = instances[i].xSize;
+        sizes[2 * i + 1] = instances[i].ySize;
+        nPoints[i] = instances[i].nPoints;
+        metrics[i] = (int) instances[i].metric;
+    }
+    MPI_Bcast(sizes.data(), (int) (2 * nInstances), MPI_DOUBLE, root, comm);
+    MPI_Bcast(nPoints.data(), (int) nInstances, MPI_UNSIGNED_LONG, root, comm);
+    MPI_Bcast(metrics.data(), (int) nInstances, MPI_INT, root, comm);
+
+    /// lay out the points and matrices of all instances in one array
+    std::vector<unsigned long> offsets(nInstances + 1, 0);
+    for (unsigned long i = 0; i < nInstances; i++) {
+        auto metric = (MetricType) metrics[i];
+        bool hasMatrix = metric == MetricType::matrix || metric == MetricType::asymmetricMatrix;
+        offsets[i + 1] = offsets[i] + 2 * nPoints[i] + (hasMatrix ? nPoints[i] * nPoints[i] : 0);
+    }
+
+    auto window = std::make_shared<SharedMemoryWindow>(comm, root, offsets[nInstances]);
+    double* data = window->getData();
+
+    /// the root process fills the array of its node, which is then broadcast to the other node leaders
+    if (id == root) {
+        for (unsigned long i = 0; i < nInstances; i++) {
+            const auto &instance = instances[i];
+            double* instanceData = &data[offsets[i]];
+            std::copy(instance.xPoints, instance.xPoints + nPoints[i], instanceData);
+            std::copy(instance.yPoints, instance.yPoints + nPoints[i], instanceData + nPoints[i]);
+            if (instance.matrix != nullptr) {
+                std::copy(instance.matrix, instance.matrix + nPoints[i] * nPoints[i], instanceData + 2 * nPoints[i]);
+            }
+        }
+    }
+    if (window->isLeader()) window->broadcastBetweenLeaders();
+    window->synchronize();
+
+    /// point all instances to the node-local array
+    for (unsigned long i = 0; i < nInstances; i++) {
+        auto &instance = instances[i];
+        double* instanceData = &data[offsets[i]];
+        bool hasMatrix = offsets[i + 1] - offsets[i] > 2 * nPoints[i];
+
+        instance.nPoints = nPoints[i];
+        instance.xSize = sizes[2 * i];
+        instance.ySize = sizes[2 * i + 1];
+        instance.metric = (MetricType) metrics[i];
+        instance.xPoints = instanceData;
+        instance.yPoints = instanceData + nPoints[i];
+        instance.matrix = hasMatrix ? instanceData + 2 * nPoints[i] : nullptr;
+        instance.storage = window;
+    }
+}
+
+void TSPInstance::share(MPI_Comm comm, int root) {
+    std::vector<TSPInstance> instances(1);
+    instances[0] = std::move(*this);
+    share(instances, comm, root);
+    *this = std::move(instances[0]);
+}
@@ -0,0 +1,71 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_TSPINSTANCE_H
+#define GATSP_TSPINSTANCE_H
+
+
+#include <mpi.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "DistanceMetric.h"
+
+struct TSPInstance {
+    std::string name;
+    unsigned long nPoints = 0;
+    double xSize = 0.0;
+    double ySize = 0.0;
+    MetricType metric = MetricType::euclidean;
+
+    /// read-only points and (for the matrix metrics) distance matrix, the memory is owned by storage
+    const double* xPoints = nullptr;
+    const double* yPoints = nullptr;
+    const double* matrix = nullptr;
+    std::shared_ptr<const void> storage;
+
+    /**
+    * @brief load an instance from a file with one 'x,y' point per line, reading at most nPoints (0: all) points
+    */
+    static TSPInstance fromFile(const std::string &fileName, unsigned long nPoints = 0);
+
+    /**
+    * @brief create an instance from the x- and y-coordinates of the points
+    */
+    static TSPInstance fromPoints(const std::vector<double> &xPoints, const std::vector<double> &yPoints);
+
+    /**
+    * @brief create an instance from a memory-mapped binary distance matrix, see MappedMatrix
+    */
+    static TSPInstance fromMatrixFile(const std::string &fileName, bool symmetric);
+
+    /**
+    * @brief create an instance with points randomly selected within the box x(0,xSize), y(0,ySize)
+    */
+    static TSPInstance random(unsigned long nPoints, double xSize, double ySize);
+
+    /**
+    * @brief create an instance with only the specified points of this instance, in the specified order (point i of the
+    * subset is point points[i] of this instance), not for the matrix metrics
+    */
+    [[nodiscard]] TSPInstance subset(const std::vector<unsigned long> &points) const;
+
+    /**
+    * @brief share the instances of the root process with all processes of the communicator
+    *
+    * The points and matrices are stored once per node in a shared memory window (see SharedMemoryWindow), which is
+    * filled by broadcasting between the node leaders only. Sharing is collective over the communicator and so is
+    * releasing the last copy of the instances, which frees the window.
+    */
+    static void share(std::vector<TSPInstance> &instances, MPI_Comm comm, int root = 0);
+
+    /**
+    * @brief share this instance of the root process with all processes of the communicator
+    */
+    void share(MPI_Comm comm, int root = 0);
+};
+
+
+#endif //GATSP_TSPINSTANCE_H
@@ -0,0 +1,107 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <iostream>
+
+#include "TSPLogReader.h"
+
+/// every run starts with a header line of column names, the first of which is the population size
+static bool isHeader(const std::string &line) {
+    auto first = line.find_first_not_of(' ');
+    return first != std::string::npos && line.compare(first, 15, "population size") == 0;
+}
+
+bool TSPLogReader::open(const std::string &fileName, unsigned long run) {
+    file.open(fileName);
+    if (!file.is_open()) {
+        std::cerr << "could not open input file " << fileName << std::endl;
+        return false;
+    }
+
+    /// skip to the header of the run
+    for (unsigned long r = 0; r < run;) {
+        if (!std::getline(file, line)) {
+            std::cerr << fileName << " contains less than " << run << " runs" << std::endl;
+            return false;
+        }
+        if (isHeader(line)) r++;
+    }
+
+    /// the line after the header holds the population size, generations and number of points, the points start
+    /// two lines later
+    std::getline(file, line);
+    if (sscanf(line.c_str(), "%lu %lu %lu", &populationSize, &generations, &nPoints) != 3) {
+        std::cerr << fileName << " is not a run log" << std::endl;
+        return false;
+    }
+    std::getline(file, line);
+    std::getline(file, line);
+
+    xPoints.resize(nPoints);
+    yPoints.resize(nPoints);
+    for (unsigned long i = 0; i < nPoints; i++) {
+        if (!std::getline(file, line) || sscanf(line.c_str(), "%lf %lf", &xPoints[i], &yPoints[i]) != 2) {
+            std::cerr << fileName << " contains less than " << nPoints << " points" << std::endl;
+            return false;
+        }
+    }
+
+    /// skip to the paths
+    while (std::getline(file, line) && line.compare(0, 10, "generation") != 0) {}
+    invalidPath = false;
+    return true;
+}
+
+unsigned long TSPLogReader::getPopulationSize() const {
+    return populationSize;
+}
+
+unsigned long TSPLogReader::getGenerations() const {
+    return generations;
+}
+
+unsigned long TSPLogReader::getNPoints() const {
+    return nPoints;
+}
+
+const std::vector<double> &TSPLogReader::getXPoints() const {
+    return xPoints;
+}
+
+const std::vector<double> &TSPLogReader::getYPoints() const {
+    return yPoints;
+}
+
+bool TSPLogReader::readPath(unsigned long &generation, double &routeLength, std::vector<unsigned long> &order) {
+    /// a path is 'generation, route length, order[0],order[1],...,order[n-1],order[0]'
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+
+        /// the header of the next run ends the paths of this run
+        if (isHeader(line)) return false;
+
+        const char* position = line.c_str();
+        char* end;
+        generation = strtoul(position, &end, 10);
+        routeLength = strtod(end + 1, &end);
+
+        order.resize(nPoints);
+        for (unsigned long i = 0; i < nPoints; i++) {
+            position = end + 1;
+            order[i] = strtoul(position, &end, 10);
+            if (end == position || order[i] >= nPoints) {
+                std::cerr << "invalid path of generation " << generation << std::endl;
+                invalidPath = true;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+bool TSPLogReader::hasInvalidPath() const {
+    return invalidPath;
+}
@@ -0,0 +1,60 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_TSPLOGREADER_H
+#define GATSP_TSPLOGREADER_H
+
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief streaming reader for the run log (tsp.dat) written by TSPOutputFile
+ *
+ * A log holds one header, points block and list of paths per run. open reads the header and points of a run, the
+ * paths of that run are read one line at a time, so the log is never loaded at once. Errors are reported to stderr
+ * and by the return values, the reader never exits the process.
+ */
+class TSPLogReader {
+private:
+    std::ifstream file;
+    std::string line;
+
+    unsigned long populationSize = 0;
+    unsigned long generations = 0;
+    unsigned long nPoints = 0;
+    bool invalidPath = false;
+    std::vector<double> xPoints;
+    std::vector<double> yPoints;
+
+public:
+    /**
+    * @brief open the log and read the header and the points of the run (counted from 1), return false on an error
+    */
+    bool open(const std::string &fileName, unsigned long run);
+
+    [[nodiscard]] unsigned long getPopulationSize() const;
+
+    [[nodiscard]] unsigned long getGenerations() const;
+
+    [[nodiscard]] unsigned long getNPoints() const;
+
+    [[nodiscard]] const std::vector<double> &getXPoints() const;
+
+    [[nodiscard]] const std::vector<double> &getYPoints() const;
+
+    /**
+    * @brief read the next path, return false at the end of the run or at an invalid path
+    */
+    bool readPath(unsigned long &generation, double &routeLength, std::vector<unsigned long> &order);
+
+    /**
+    * @brief return true if reading the paths stopped at an invalid path instead of the end of the run
+    */
+    [[nodiscard]] bool hasInvalidPath() const;
+};
+
+
+#endif //GATSP_TSPLOGREADER_H
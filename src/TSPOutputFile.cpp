@@ -0,0 +1,57 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include <iostream>
+
+#include "TSPOutputFile.h"
+
+TSPOutputFile::TSPOutputFile(const char* fileName, unsigned long cout_) : cout(cout_) {
+    file = fopen(fileName, "w");
+    if (file == nullptr) {
+        std::cerr << "could not open output file " << fileName << std::endl;
+        exit(-1);
+    }
+}
+
+TSPOutputFile::~TSPOutputFile() {
+    fclose(file);
+}
+
+void TSPOutputFile::printPoints(unsigned long populationSize, unsigned long generations,
+                                const TSPInstance &instance) {
+    nPoints = instance.nPoints;
+
+    fprintf(file, "%20s %20s %20s %20s %20s\n",
+            "population size", "generations", "number of points", "box size (x)", "box size (y)");
+    fprintf(file, "%20lu %20lu %20lu %20.10g %20.10g\n\n%20s %20s\n",
+            populationSize, generations, nPoints, instance.xSize, instance.ySize, "xPoints", "yPoints");
+
+    for (unsigned long i = 0; i < nPoints; i++) {
+        fprintf(file, "%20.10g %20.10g\n", instance.xPoints[i], instance.yPoints[i]);
+    }
+    fprintf(file, "\n\ngeneration, path-length, path-order[number of points in path]\n");
+}
+
+void TSPOutputFile::printPath(unsigned long generation, double routeLength, const std::vector<unsigned long> &order,
+                              double lowerBound) {
+    /// print the generation, route length and path order to file
+    fprintf(file, "%lu, %f, ", generation, routeLength);
+    for (unsigned long i = 0; i < nPoints; i++) {
+        fprintf(file, "%lu,", order[i]);
+    }
+    fprintf(file, "%lu\n", order[0]);
+
+    /// print to terminal every 'cout' generations if cout is non-zero
+    if (cout > 0 && generation % cout == 0) {
+        std::cout << "generation: " << generation << "\nroute length: " << routeLength;
+        if (lowerBound > 0.0) {
+            std::cout << ", gap: " << 100.0 * (routeLength - lowerBound) / lowerBound << "%";
+        }
+        std::cout << ", path: ";
+        for (unsigned long i = 0; i < nPoints; i++) {
+            std::cout << order[i] << " ";
+        }
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,49 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_TSPOUTPUTFILE_H
+#define GATSP_TSPOUTPUTFILE_H
+
+
+#include <cstdio>
+#include <vector>
+
+#include "TSPInstance.h"
+
+/**
+ * @brief writer for the run log (tsp.dat) read by plottsp.py, only used by the root process
+ */
+class TSPOutputFile {
+private:
+    FILE* file;
+    unsigned long cout;
+    unsigned long nPoints = 0;
+
+public:
+    /**
+    * @brief open the file, cout is the interval for printing the best route to stdout
+    */
+    TSPOutputFile(const char* fileName, unsigned long cout_);
+
+    TSPOutputFile(const TSPOutputFile &) = delete;
+
+    TSPOutputFile &operator=(const TSPOutputFile &) = delete;
+
+    ~TSPOutputFile();
+
+    /**
+    * @brief print the header and the x- and y-points to the file
+    */
+    void printPoints(unsigned long populationSize, unsigned long generations, const TSPInstance &instance);
+
+    /**
+    * @brief print the path with the specified generation, route length and path order, and the gap to the
+    * lower bound on the terminal if it is non-zero
+    */
+    void printPath(unsigned long generation, double routeLength, const std::vector<unsigned long> &order,
+                   double lowerBound = 0.0);
+};
+
+
+#endif //GATSP_TSPOUTPUTFILE_H
@@ -0,0 +1,78 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_TSPPARAMETERS_H
+#define GATSP_TSPPARAMETERS_H
+
+
+struct TSPParameters {
+    /// total population size, divided between the processes of the communicator
+    unsigned long populationSize = 2000;
+
+    /// number of generations, 0: run until one of the termination criteria is met
+    unsigned long generations = 500;
+
+    /// number of parents migrating left/right per migration round
+    unsigned long nMigrate = 20;
+
+    /// number of parents not reproducing, to keep the optimal solution
+    unsigned long nKeepBestParents = 2;
+
+    /// number of generations between migration
+    unsigned long generationsBetweenMigrate = 5;
+
+    /// number of islands (sub-populations) per process, only the best parents of a process migrate between processes
+    unsigned long nIslands = 1;
+
+    /// number of parents migrating left/right between the islands of a process per island migration round
+    unsigned long nIslandMigrate = 2;
+
+    /// number of generations between migration between the islands of a process
+    unsigned long generationsBetweenIslandMigrate = 5;
+
+    /// choose the mutation operator of every child with a bandit per island, instead of always a random swap
+    bool adaptiveMutation = true;
+
+    /// replace the worst routes one offspring at a time instead of replacing all parents every generation
+    bool steadyState = false;
+
+    /// number of offspring per generation in steady state mode
+    unsigned long nOffspring = 16;
+
+    /// size the populations (or in steady state mode the offspring) of the processes proportional to their throughput
+    bool balancePopulation = false;
+
+    /// number of generations between measuring the throughput and balancing the populations
+    unsigned long generationsBetweenBalance = 50;
+
+    /// wall-clock time per solve in seconds (0: no time limit)
+    double timeBudget = 0.0;
+
+    /// stop once a route of at most this length is found (0: no target)
+    double targetLength = 0.0;
+
+    /// stop if no process improved its best route for this many generations (0: no limit)
+    unsigned long stagnationGenerations = 0;
+
+    /// number of subgradient iterations for the Held-Karp lower bound (0: no lower bound)
+    unsigned long boundIterations = 0;
+
+    /// stop once the best route is within this fraction of the lower bound, e.g. 0.01 for 1% (0: off)
+    double targetGap = 0.0;
+
+    /// decomposition solver only: maximum number of points per spatial cluster
+    unsigned long clusterSize = 200;
+
+    /// decomposition solver only: number of points on either side of a joint between clusters that are refined
+    unsigned long jointWindow = 25;
+
+    /// number of generations between reducing the metrics of the run to the metrics callback (0: off)
+    unsigned long metricsInterval = 0;
+
+    /// gather the global best path every generation and pass it to the best path callback (0: off)
+    unsigned long cout = 0;
+};
+
+
+#endif //GATSP_TSPPARAMETERS_H
@@ -3,25 +3,43 @@
 //
 
 #include <algorithm>
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
 
 #include "TSPRoute.h"
 #include "Random.h"
 
+#define TSP_SCRAMBLE_LENGTH 8                           // maximum number of cities shuffled by the scramble mutation
+#define TSP_MUTATION_COST_BATCH 1000                    // number of mutations timed together to measure their cost
+
 const std::vector<unsigned long> &TSPRoute::getOrder() const {
     return order;
 }
 
-void TSPRoute::setOrder(std::vector<unsigned long> route) {
-    order = {};
+void TSPRoute::setRouteSize(unsigned long nPoints_, bool symmetric_) {
+    nPoints = nPoints_;
+    symmetric = symmetric_;
     routeLength = 0.0;
-    std::copy(&route[0], &route[nPoints], back_inserter(order));
+}
+
+template<class Metric>
+void TSPRoute::setOrder(const std::vector<unsigned long> &route, const Metric &metric) {
+    order.assign(route.begin(), route.begin() + (long) nPoints);
     setUniqueEncoding();
+    setRouteLength(metric);
+}
+
+void TSPRoute::setOrder(const TSPRoute* route) {
+    order.assign(route->order.begin(), route->order.end());
+    routeLength = route->routeLength;
 }
 
-void TSPRoute::setRandomOrder() {
+template<class Metric>
+void TSPRoute::setRandomOrder(const Metric &metric) {
     /// set the route in order of index
-    order = std::vector<unsigned long>(nPoints);
-    routeLength = 0.0;
+    order.resize(nPoints);
     for (unsigned long i = 0; i < nPoints; i++) {
         order[i] = i;
     }
@@ -29,15 +47,51 @@ void TSPRoute::setRandomOrder() {
     /// shuffle the points in the route
     std::shuffle(order.begin(), order.end(), Random::getRNG());
     setUniqueEncoding();
+    setRouteLength(metric);
 }
 
-void TSPRoute::setOrderFromParents(TSPRoute* parent1, TSPRoute* parent2) {
+template<class Metric>
+void TSPRoute::setOrderFromParents(const TSPRoute* parent1, const TSPRoute* parent2, Mutation &mutation,
+                                   const Metric &metric) {
+    /// metrics of a fixed size get the crossover specialised for their size
+    if constexpr (fixedSize<Metric> > 0) {
+        setFixedCrossoverOrder<fixedSize<Metric>>(parent1, parent2, metric);
+    } else {
+        setCrossoverOrder(parent1, parent2, metric);
+    }
+    setRouteLength(metric);
+
+    /// mutate the child, measuring the improvement made by the operator
+    MutationOperator mutationOperator = mutation.select();
+    double oldRouteLength = routeLength;
+    mutate(mutationOperator, metric);
+    mutation.update(mutationOperator, oldRouteLength - routeLength);
+
+    setUniqueEncoding();
+}
+
+template<class Metric>
+MutationCostArray TSPRoute::getMutationCosts(const Metric &metric) {
+    /// time a batch of mutations per operator, so the two clock reads are negligible
+    MutationCostArray costs{};
+    for (unsigned long i = 0; i < nMutationOperators; i++) {
+        auto startTime = std::chrono::steady_clock::now();
+        for (unsigned long j = 0; j < TSP_MUTATION_COST_BATCH; j++) mutate((MutationOperator) i, metric);
+        std::chrono::duration<double> time = std::chrono::steady_clock::now() - startTime;
+        costs[i] = time.count() / TSP_MUTATION_COST_BATCH;
+    }
+
+    setUniqueEncoding();
+    return costs;
+}
+
+template<class Metric>
+void TSPRoute::setCrossoverOrder(const TSPRoute* parent1, const TSPRoute* parent2, const Metric &metric) {
     /// create new order vector and get the order of each parent
     std::vector<bool> orderContains(nPoints, false);
-    order = std::vector<unsigned long>(nPoints, -1);
-    routeLength = 0.0;
-    auto parent1order = parent1->getOrder();
-    auto parent2order = parent2->getOrder();
+    order.assign(nPoints, -1);
+    const auto &parent1order = parent1->getOrder();
+    const auto &parent2order = parent2->getOrder();
 
     /// set first city as the first city from one of the parents randomly
     int r = Random::randInt(0, 1);
@@ -92,68 +146,233 @@ void TSPRoute::setOrderFromParents(TSPRoute* parent1, TSPRoute* parent2) {
             orderContains[order[i]] = true;
         } else {
             /// both parents have a city left, therefore choose the closest city
-            double dist1 = getDistSquared(parent1order[v1], order[i - 1]);
-            double dist2 = getDistSquared(parent2order[v2], order[i - 1]);
+            double dist1 = metric.compare(order[i - 1], parent1order[v1]);
+            double dist2 = metric.compare(order[i - 1], parent2order[v2]);
 
             order[i] = (dist1 < dist2) ? parent1order[v1] : parent2order[v2];
             orderContains[order[i]] = true;
         }
     }
+}
+
+template<unsigned long N, class Metric>
+void TSPRoute::setFixedCrossoverOrder(const TSPRoute* parent1, const TSPRoute* parent2, const Metric &metric) {
+    static_assert(N <= 256, "the cities of a fixed-size route are stored as uint8_t");
+
+    /// copy the parents to compact arrays, which are scanned repeatedly below
+    std::array<uint8_t, N> parent1order, parent2order, child;
+    for (unsigned long i = 0; i < nPoints; i++) {
+        parent1order[i] = (uint8_t) parent1->order[i];
+        parent2order[i] = (uint8_t) parent2->order[i];
+    }
+    std::bitset<N> orderContains;
+
+    /// set first city as the first city from one of the parents randomly
+    int r = Random::randInt(0, 1);
+    child[0] = r ? parent1order[0] : parent2order[0];
+    orderContains.set(child[0]);
+
+    /// add new points to the child iteratively, choosing between the parents as in setCrossoverOrder
+    for (unsigned long i = 1; i < nPoints; i++) {
+        unsigned long v1 = i, v2 = i;
+        while (orderContains[parent1order[v1]] && ++v1 < nPoints) {}
+        while (orderContains[parent2order[v2]] && ++v2 < nPoints) {}
+
+        if (v1 >= nPoints && v2 >= nPoints) {
+            /// no parent cities left, append the remaining cities in random order
+            for (; i < nPoints; i++) {
+                int element = Random::randInt(0, (int) (nPoints - i) - 1);
+                unsigned long j = 0;
+                while (orderContains[j] || element-- > 0) j++;
+                child[i] = (uint8_t) j;
+                orderContains.set(j);
+            }
+            break;
+        } else if (v1 >= nPoints) {
+            child[i] = parent2order[v2];
+        } else if (v2 >= nPoints) {
+            child[i] = parent1order[v1];
+        } else {
+            double dist1 = metric.compare(child[i - 1], parent1order[v1]);
+            double dist2 = metric.compare(child[i - 1], parent2order[v2]);
+            child[i] = (dist1 < dist2) ? parent1order[v1] : parent2order[v2];
+        }
+        orderContains.set(child[i]);
+    }
 
-    /// add a random mutation by swapping two cities
+    order.assign(child.begin(), child.begin() + (long) nPoints);
+}
+
+template<class Metric>
+double TSPRoute::getEdgesLength(unsigned long first, unsigned long count, const Metric &metric) const {
+    double length = 0.0;
+    for (unsigned long i = first; i < first + count; i++) {
+        length += metric(order[i % nPoints], order[(i + 1) % nPoints]);
+    }
+    return length;
+}
 
-    /// get two unique indices and swap their values
+template<class Metric>
+void TSPRoute::mutate(MutationOperator mutationOperator, const Metric &metric) {
+    switch (mutationOperator) {
+        case MutationOperator::swap:
+            swapCities(metric);
+            break;
+        case MutationOperator::inversion:
+            invertSegment(metric);
+            break;
+        case MutationOperator::insertion:
+            insertCity(metric);
+            break;
+        case MutationOperator::scramble:
+            scrambleSegment(metric);
+            break;
+        case MutationOperator::doubleBridge:
+            doubleBridge(metric);
+            break;
+    }
+}
+
+template<class Metric>
+void TSPRoute::swapCities(const Metric &metric) {
+    /// get two unique indices
     int r1 = Random::randInt(0, (int) nPoints - 1);
     int r2 = Random::randInt(0, (int) nPoints - 1);
     while (r2 == r1) r2 = Random::randInt(0, (int) nPoints - 1);
+    auto i = (unsigned long) std::min(r1, r2);
+    auto j = (unsigned long) std::max(r1, r2);
 
-    std::swap(order[r1], order[r2]);
+    /// the edges into and out of both cities, which are three edges if the cities are neighbours
+    auto getLength = [this, i, j, &metric]() {
+        if (j == i + 1) return getEdgesLength(i + nPoints - 1, 3, metric);
+        if (i == 0 && j == nPoints - 1) return getEdgesLength(nPoints - 2, 3, metric);
+        return getEdgesLength(i + nPoints - 1, 2, metric) + getEdgesLength(j - 1, 2, metric);
+    };
 
-    setUniqueEncoding();
+    routeLength -= getLength();
+    std::swap(order[i], order[j]);
+    routeLength += getLength();
 }
 
-double TSPRoute::getRouteLength() {
-    /// make sure the route length is only calculated once
-    if (routeLength != 0.0) {
-        return routeLength;
+template<class Metric>
+void TSPRoute::invertSegment(const Metric &metric) {
+    /// reverse the segment from i to j, keeping the first city in place
+    int r1 = Random::randInt(1, (int) nPoints - 1);
+    int r2 = Random::randInt(1, (int) nPoints - 1);
+    while (r2 == r1) r2 = Random::randInt(1, (int) nPoints - 1);
+    auto i = (unsigned long) std::min(r1, r2);
+    auto j = (unsigned long) std::max(r1, r2);
+    unsigned long next = (j + 1) % nPoints;
+
+    if constexpr (Metric::symmetric) {
+        /// only the edges at both ends of the segment change
+        routeLength += metric(order[i - 1], order[j]) + metric(order[i], order[next]) -
+                       metric(order[i - 1], order[i]) - metric(order[j], order[next]);
+        std::reverse(order.begin() + (long) i, order.begin() + (long) j + 1);
+    } else {
+        /// all edges in the segment change direction
+        routeLength -= getEdgesLength(i - 1, j - i + 2, metric);
+        std::reverse(order.begin() + (long) i, order.begin() + (long) j + 1);
+        routeLength += getEdgesLength(i - 1, j - i + 2, metric);
     }
+}
 
-    /// calculate sum of distances between consecutive points in the path order, returning back to the starting point
-    for (unsigned long i = 0; i < nPoints; i++) {
-        unsigned long j = (i == 0) ? nPoints - 1 : i - 1;
-        routeLength += getDist(order[i], order[j]);
+template<class Metric>
+void TSPRoute::insertCity(const Metric &metric) {
+    /// take the city at index i out and insert it before the city at index j of the remaining route, which is not
+    /// the place it was taken from
+    auto i = (unsigned long) Random::randInt(0, (int) nPoints - 1);
+    auto j = (unsigned long) Random::randInt(0, (int) nPoints - 3);
+    if (j >= i % (nPoints - 1)) j++;
+
+    auto getRemaining = [this, i = i](unsigned long k) { return order[k < i ? k : k + 1]; };
+    unsigned long city = order[i];
+    unsigned long previous = order[(i + nPoints - 1) % nPoints];
+    unsigned long next = order[(i + 1) % nPoints];
+    unsigned long before = getRemaining((j + nPoints - 2) % (nPoints - 1));
+    unsigned long after = getRemaining(j);
+
+    routeLength += metric(previous, next) - metric(previous, city) - metric(city, next) +
+                   metric(before, city) + metric(city, after) - metric(before, after);
+
+    if (j < i) {
+        std::rotate(order.begin() + (long) j, order.begin() + (long) i, order.begin() + (long) i + 1);
+    } else {
+        std::rotate(order.begin() + (long) i, order.begin() + (long) i + 1, order.begin() + (long) j + 1);
     }
+}
 
-    return routeLength;
+template<class Metric>
+void TSPRoute::scrambleSegment(const Metric &metric) {
+    /// shuffle the k cities starting at index i, keeping the first city in place
+    auto k = (unsigned long) Random::randInt(3, (int) std::min((unsigned long) TSP_SCRAMBLE_LENGTH, nPoints - 1));
+    auto i = (unsigned long) Random::randInt(1, (int) (nPoints - k));
+
+    routeLength -= getEdgesLength(i - 1, k + 1, metric);
+    std::shuffle(order.begin() + (long) i, order.begin() + (long) (i + k), Random::getRNG());
+    routeLength += getEdgesLength(i - 1, k + 1, metric);
 }
 
-double TSPRoute::getDistSquared(unsigned long indexA, unsigned long indexB) const {
-    double &xA = xPoints[indexA];
-    double &xB = xPoints[indexB];
-    double &yA = yPoints[indexA];
-    double &yB = yPoints[indexB];
+template<class Metric>
+void TSPRoute::doubleBridge(const Metric &metric) {
+    /// get three unique cut points, A = [0, p1), B = [p1, p2), C = [p2, p3), D = [p3, nPoints)
+    std::array<unsigned long, 3> cuts{};
+    for (unsigned long c = 0; c < 3; c++) {
+        do {
+            cuts[c] = (unsigned long) Random::randInt(1, (int) nPoints - 1);
+        } while (std::find(cuts.begin(), cuts.begin() + (long) c, cuts[c]) != cuts.begin() + (long) c);
+    }
+    std::sort(cuts.begin(), cuts.end());
+    auto [p1, p2, p3] = cuts;
 
-    return ((xA - xB) * (xA - xB) + (yA - yB) * (yA - yB));
+    /// the three edges between the parts are replaced, the parts keep their direction
+    routeLength += metric(order[p1 - 1], order[p2]) + metric(order[p3 - 1], order[p1]) +
+                   metric(order[p2 - 1], order[p3]) - metric(order[p1 - 1], order[p1]) -
+                   metric(order[p2 - 1], order[p2]) - metric(order[p3 - 1], order[p3]);
+    std::rotate(order.begin() + (long) p1, order.begin() + (long) p2, order.begin() + (long) p3);
 }
 
-double TSPRoute::getDist(unsigned long indexA, unsigned long indexB) const {
-    return std::sqrt(getDistSquared(indexA, indexB));
+template<class Metric>
+void TSPRoute::setRouteLength(const Metric &metric) {
+    /// calculate sum of distances between consecutive points in the path order, returning back to the starting point
+    routeLength = 0.0;
+    for (unsigned long i = 0; i < nPoints; i++) {
+        unsigned long j = (i == 0) ? nPoints - 1 : i - 1;
+        routeLength += metric(order[j], order[i]);
+    }
+}
+
+double TSPRoute::getRouteLength() const {
+    return routeLength;
 }
 
 void TSPRoute::setUniqueEncoding() {
+    /// set the order such that 0 is the first index
     auto itOrder = std::find(order.begin(), order.end(), 0);
-    unsigned long itIndex = itOrder - order.begin();
-
-    if (itIndex != 0) {
-        /// set the order such that 0 is the first index
-        std::vector<unsigned long> tempswap(nPoints);
-        std::copy(itOrder, order.end(), tempswap.begin());
-        std::copy(order.begin(), itOrder, tempswap.begin() + nPoints - itIndex);
-        tempswap.swap(order);
-    }
+    std::rotate(order.begin(), itOrder, order.end());
 
-    if (order[nPoints - 1] > order[1]) {
+    if (symmetric && order[nPoints - 1] > order[1]) {
         /// set the value at index 1 is larger than the value at the last index by reversing the order
         std::reverse(order.begin() + 1, order.end());
     }
 }
+
+/// instantiate the templated member functions for every distance metric
+#define TSP_INSTANTIATE_ROUTE(...) \
+    template void TSPRoute::setRandomOrder<__VA_ARGS__>(const __VA_ARGS__ &); \
+    template void TSPRoute::setOrder<__VA_ARGS__>(const std::vector<unsigned long> &, const __VA_ARGS__ &); \
+    template void TSPRoute::setOrderFromParents<__VA_ARGS__>(const TSPRoute*, const TSPRoute*, Mutation &, \
+                                                             const __VA_ARGS__ &); \
+    template MutationCostArray TSPRoute::getMutationCosts<__VA_ARGS__>(const __VA_ARGS__ &);
+
+TSP_INSTANTIATE_ROUTE(EuclideanMetric)
+TSP_INSTANTIATE_ROUTE(ManhattanMetric)
+TSP_INSTANTIATE_ROUTE(GeographicMetric)
+TSP_INSTANTIATE_ROUTE(MatrixMetric)
+TSP_INSTANTIATE_ROUTE(AsymmetricMatrixMetric)
+TSP_INSTANTIATE_ROUTE(SmallMatrixMetric<64, true>)
+TSP_INSTANTIATE_ROUTE(SmallMatrixMetric<64, false>)
+TSP_INSTANTIATE_ROUTE(SmallMatrixMetric<128, true>)
+TSP_INSTANTIATE_ROUTE(SmallMatrixMetric<128, false>)
+TSP_INSTANTIATE_ROUTE(SmallMatrixMetric<256, true>)
+TSP_INSTANTIATE_ROUTE(SmallMatrixMetric<256, false>)
@@ -9,37 +9,114 @@
 #include <iostream>
 #include <vector>
 
+#include "DistanceMetric.h"
+#include "Mutation.h"
+
 class TSPRoute {
 private:
     std::vector<unsigned long> order;
     double routeLength = 0.0;
 
     unsigned long nPoints;
-    double* xPoints;
-    double* yPoints;
+    bool symmetric;
 
     /**
     * @brief set a unique encoding for the route: set the order such that 0 is the first index,
-    * and the value at index 1 is larger than the value at the last index.
+    * and (for symmetric metrics only) the value at index 1 is larger than the value at the last index.
     */
     void setUniqueEncoding();
 
+    /**
+     * @brief set the order of the route by the greedy crossover of two parents, see setOrderFromParents
+     */
+    template<class Metric>
+    void setCrossoverOrder(const TSPRoute* parent1, const TSPRoute* parent2, const Metric &metric);
+
+    /**
+     * @brief greedy crossover for routes of at most N points, using fixed-size arrays of compact indices for the
+     * parents and child, and a bitmask of the cities included in the child
+     */
+    template<unsigned long N, class Metric>
+    void setFixedCrossoverOrder(const TSPRoute* parent1, const TSPRoute* parent2, const Metric &metric);
+
+    /**
+     * @brief return the total length of count consecutive edges of the route, starting at the edge from the point at
+     * index first to the next point, wrapping around the end of the route
+     */
+    template<class Metric>
+    double getEdgesLength(unsigned long first, unsigned long count, const Metric &metric) const;
+
+    /**
+     * @brief apply the mutation operator, updating the route length by the difference of the changed edges
+     */
+    template<class Metric>
+    void mutate(MutationOperator mutationOperator, const Metric &metric);
+
+    /**
+     * @brief swap two random cities, O(1)
+     */
+    template<class Metric>
+    void swapCities(const Metric &metric);
+
+    /**
+     * @brief reverse a random segment, which replaces two edges (a 2-opt move), O(1) length difference for symmetric
+     * metrics and O(k) for asymmetric metrics
+     */
+    template<class Metric>
+    void invertSegment(const Metric &metric);
+
+    /**
+     * @brief move a random city to a random other position, O(1) length difference
+     */
+    template<class Metric>
+    void insertCity(const Metric &metric);
+
+    /**
+     * @brief shuffle a random segment of at most TSP_SCRAMBLE_LENGTH cities, O(k)
+     */
+    template<class Metric>
+    void scrambleSegment(const Metric &metric);
+
+    /**
+     * @brief cut the route in four parts A B C D and reconnect them as A C B D, O(1) length difference
+     */
+    template<class Metric>
+    void doubleBridge(const Metric &metric);
+
+    /**
+     * @brief calculate the total length of the route, returning back to the starting point
+     */
+    template<class Metric>
+    void setRouteLength(const Metric &metric);
+
 public:
 
-    TSPRoute(unsigned long nPoints, double* xPoints, double* yPoints)
-          : nPoints(nPoints), xPoints(xPoints), yPoints(yPoints) {}
+    TSPRoute(unsigned long nPoints, bool symmetric)
+          : nPoints(nPoints), symmetric(symmetric) {}
+
+    /**
+     * @brief set the size of the route for a new instance, keeping the allocated order to reuse it
+     */
+    void setRouteSize(unsigned long nPoints_, bool symmetric_);
 
     [[nodiscard]] const std::vector<unsigned long> &getOrder() const;
 
     /**
      * @brief set a route randomly by shuffling the points around
      */
-    void setRandomOrder();
+    template<class Metric>
+    void setRandomOrder(const Metric &metric);
 
     /**
      * @brief set a route from a vector
      */
-    void setOrder(std::vector<unsigned long> route);
+    template<class Metric>
+    void setOrder(const std::vector<unsigned long> &route, const Metric &metric);
+
+    /**
+     * @brief copy the order and route length of another route
+     */
+    void setOrder(const TSPRoute* route);
 
     /**
      * @brief set the route of the child using two parents and some heuristics
@@ -55,23 +132,23 @@ public:
      * cycle).
      *
      * 4. Go in a similar fashion through all the cities until the child has all cities
+     *
+     * 5. Mutate the child with the operator chosen by mutation, which is updated with the result.
      */
-    void setOrderFromParents(TSPRoute* parent1, TSPRoute* parent2);
-
-    /**
-     * @brief return the total length of the route
-     */
-    double getRouteLength();
+    template<class Metric>
+    void setOrderFromParents(const TSPRoute* parent1, const TSPRoute* parent2, Mutation &mutation,
+                             const Metric &metric);
 
     /**
-     * @brief return the distance squared between two points (indices) in the vector 'order'
+     * @brief return the mean time of a mutation by every operator, measured by mutating this route in batches
      */
-    [[nodiscard]] double getDistSquared(unsigned long indexA, unsigned long indexB) const;
+    template<class Metric>
+    MutationCostArray getMutationCosts(const Metric &metric);
 
     /**
-     * @brief return the distance between two points (indices) in the vector 'order'
+     * @brief return the total length of the route
      */
-    [[nodiscard]] double getDist(unsigned long indexA, unsigned long indexB) const;
+    [[nodiscard]] double getRouteLength() const;
 };
 
 
@@ -0,0 +1,51 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#include "TSPSolver.h"
+#include "HeldKarpBound.h"
+
+TSPSolver::TSPSolver(MPI_Comm comm) : mpiController(comm), travellingSalesman(&mpiController) {}
+
+void TSPSolver::setBestPathCallback(BestPathCallback bestPathCallback) {
+    travellingSalesman.setBestPathCallback(std::move(bestPathCallback));
+}
+
+void TSPSolver::setMetricsCallback(MetricsCallback metricsCallback) {
+    travellingSalesman.setMetricsCallback(std::move(metricsCallback));
+}
+
+double TSPSolver::getLowerBound() const {
+    return lowerBound;
+}
+
+TSPSolution TSPSolver::solve(const TSPInstance &instance, const TSPParameters &params) {
+    travellingSalesman.setParameters(params);
+    travellingSalesman.setInstance(instance);
+
+    /// ----- compute the lower bound for the optimality gap -----
+    lowerBound = 0.0;
+    if (params.boundIterations > 0) {
+        lowerBound = HeldKarpBound(mpiController.getComm()).compute(instance, params.boundIterations);
+    }
+    travellingSalesman.setLowerBound(lowerBound);
+
+    /// ----- create a population of paths -----
+    travellingSalesman.createPopulation();
+
+    /// ----- create new generations of paths in a loop -----
+    TSPSolution solution;
+    while (!travellingSalesman.isFinished(solution.generations)) {
+        travellingSalesman.runGeneration(solution.generations);
+        travellingSalesman.reportMetrics(solution.generations++);
+    }
+    travellingSalesman.finishMetrics();
+
+    /// ----- share the global best path with all processes -----
+    solution.routeLength = travellingSalesman.getBestRouteLength();
+    solution.lowerBound = lowerBound;
+    solution.order = travellingSalesman.getBestOrder();
+    mpiController.allreduceBestPath(solution.routeLength, solution.order.data());
+
+    return solution;
+}
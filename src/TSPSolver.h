@@ -0,0 +1,65 @@
+//
+// Created by thijs on 19-10-26.
+//
+
+#ifndef GATSP_TSPSOLVER_H
+#define GATSP_TSPSOLVER_H
+
+
+#include <mpi.h>
+#include <vector>
+
+#include "MPIController.h"
+#include "TravellingSalesman.h"
+#include "TSPInstance.h"
+#include "TSPParameters.h"
+
+struct TSPSolution {
+    double routeLength = 0.0;
+    double lowerBound = 0.0;
+    unsigned long generations = 0;
+    std::vector<unsigned long> order;
+};
+
+/**
+ * @brief reusable solver for the processes of a communicator
+ *
+ * The solver does not initialize or finalize MPI and does not write files. All processes of the communicator call
+ * solve collectively with the same instance and parameters. The population is kept between calls, so solving
+ * instances of similar size one after another does not reallocate the routes.
+ */
+class TSPSolver {
+private:
+    MPIController mpiController;
+    TravellingSalesman travellingSalesman;
+    double lowerBound = 0.0;
+
+public:
+    explicit TSPSolver(MPI_Comm comm = MPI_COMM_WORLD);
+
+    /**
+     * @brief set the function called on the root process with the global best path if the parameter cout is non-zero
+     */
+    void setBestPathCallback(BestPathCallback bestPathCallback);
+
+    /**
+     * @brief set the function called on the root process with the metrics if the parameter metricsInterval is non-zero
+     */
+    void setMetricsCallback(MetricsCallback metricsCallback);
+
+    /**
+     * @brief return the Held-Karp lower bound of the instance being solved (0.0 if it is not computed)
+     */
+    [[nodiscard]] double getLowerBound() const;
+
+    /**
+     * @brief solve the instance and return the global best route on all processes
+     *
+     * If params.boundIterations is non-zero, the Held-Karp lower bound is computed in parallel before the first
+     * generation.
+     */
+    TSPSolution solve(const TSPInstance &instance, const TSPParameters &params);
+};
+
+
+#endif //GATSP_TSPSOLVER_H
@@ -4,184 +4,646 @@
 
 #include <iostream>
 #include <algorithm>
-#include <fstream>
-#include <sstream>
+#include <limits>
+#include <numeric>
 
 #include "TravellingSalesman.h"
 #include "Random.h"
 #include "TSPRoute.h"
 #include "MPIController.h"
+#include "TSPInstance.h"
 
-TravellingSalesman::TravellingSalesman(int argc, char** argv, MPIController* mpiController_,
-                                       unsigned long nKeepBestParents_, unsigned long generationsBetweenMigrate_) {
+TravellingSalesman::TravellingSalesman(MPIController* mpiController_) : mpiController(mpiController_) {}
 
-    /// get input parameters
-    char* pEnd;
-    populationSize = strtol(*++argv, &pEnd, 10);
-    generations = strtol(*++argv, &pEnd, 10);
-    nPoints = strtol(*++argv, &pEnd, 10);
-    xSize = strtod(*++argv, &pEnd);
-    ySize = argc > 5 ? strtod(*++argv, &pEnd) : xSize;
+TravellingSalesman::~TravellingSalesman() {
+    for (auto &route : tspChildren) delete route;
+    for (auto &route : tspParents) delete route;
+}
+
+void TravellingSalesman::setParameters(const TSPParameters &params) {
+    int nTasks = mpiController->getNTasks();
 
     /// check if the input parameters are valid
-    if (populationSize < 1 || populationSize >= 100000) {
+    if (params.populationSize < 1 || params.populationSize >= 100000) {
         std::cerr << "pop_size should be between 1 and 100000" << std::endl;
         exit(-1);
     }
-    if (generations < 1 || generations >= 10000) {
-        std::cerr << "gens should be between 1 and 10000" << std::endl;
+    if (params.populationSize < (2 * params.nMigrate + params.nKeepBestParents + 2) * nTasks) {
+        std::cerr << "pop_size should be at least twice the migrating population plus the kept best parents plus 2, "
+                     "times the number of processes" << std::endl;
         exit(-1);
     }
-    if (nPoints < 4 || nPoints >= 10000) {
-        std::cerr << "n_route should be between 4 and 10000" << std::endl;
+    if (params.steadyState && params.nOffspring < 1) {
+        std::cerr << "the number of offspring should be at least 1 in steady state mode" << std::endl;
+        exit(-1);
+    }
+    if (params.balancePopulation && params.generationsBetweenBalance < 1) {
+        std::cerr << "generations between balance should be at least 1" << std::endl;
         exit(-1);
     }
-    if (xSize < 0.1 || xSize >= 10000.0) {
-        std::cerr << "x_size should be between 0.1 and 10000" << std::endl;
+    if (params.nIslands < 1) {
+        std::cerr << "the number of islands should be at least 1" << std::endl;
         exit(-1);
     }
-    if (ySize < 0.1 || ySize >= 10000.0) {
-        std::cerr << "y_size should be between 0.1 and 10000" << std::endl;
+    if (params.nIslands > 1 && params.steadyState) {
+        std::cerr << "multiple islands per process are only supported in generational mode" << std::endl;
+        exit(-1);
+    }
+    if (params.nIslands > 1 &&
+        params.populationSize < (2 * params.nIslandMigrate + params.nKeepBestParents + 2) * params.nIslands * nTasks) {
+        std::cerr << "pop_size should be larger than twice the island migrating population times number of islands "
+                     "and processes" << std::endl;
+        exit(-1);
+    }
+    if (params.nIslands > 1 && params.generationsBetweenIslandMigrate < 1) {
+        std::cerr << "generations between island migrate should be at least 1" << std::endl;
+        exit(-1);
+    }
+    if (params.generationsBetweenMigrate < 1) {
+        std::cerr << "generations between migrate should be at least 1" << std::endl;
         exit(-1);
     }
 
-    /// allocate space for the x- and y-points
-    xPoints = new double[nPoints];
-    yPoints = new double[nPoints];
+    /// without a generation limit at least one other criterion is needed to stop the run
+    if (params.generations == 0 && params.timeBudget <= 0.0 && params.targetLength <= 0.0 &&
+        params.stagnationGenerations == 0 && (params.targetGap <= 0.0 || params.boundIterations == 0)) {
+        std::cerr << "gens = 0 requires a time budget, target length, target gap or stagnation limit" << std::endl;
+        exit(-1);
+    }
 
-    mpiController = mpiController_;
-    nKeepBestParents = nKeepBestParents_;
-    generationsBetweenMigrate = generationsBetweenMigrate_;
+    /// divide population size between processes, the first processes get one more parent for the remainder
+    int id = mpiController->getID();
+    populationSize = params.populationSize / nTasks + ((unsigned long) id < params.populationSize % nTasks ? 1 : 0);
+    generations = params.generations;
+    nKeepBestParents = params.nKeepBestParents;
+    generationsBetweenMigrate = params.generationsBetweenMigrate;
+    nMigrate = params.nMigrate;
+    nIslands = params.nIslands;
+    nIslandMigrate = params.nIslandMigrate;
+    generationsBetweenIslandMigrate = params.generationsBetweenIslandMigrate;
+    adaptiveMutation = params.adaptiveMutation;
+    cout = params.cout;
+    steadyState = params.steadyState;
+    nOffspring = params.nOffspring;
+    balancePopulation = params.balancePopulation;
+    generationsBetweenBalance = params.generationsBetweenBalance;
+    metricsInterval = params.metricsInterval;
+
+    timeBudget = params.timeBudget;
+    targetLength = params.targetLength;
+    targetGap = params.targetGap;
+    lowerBound = 0.0;
+    stagnationGenerations = params.stagnationGenerations;
+}
 
-    // divide population size between processes (assuming it is divisible by nTasks)
-    int nTasks = mpiController->getNTasks();
-    populationSize /= nTasks;
+void TravellingSalesman::setInstance(const TSPInstance &instance) {
+    if (instance.nPoints < 4 || instance.nPoints >= 10000) {
+        std::cerr << "n_route should be between 4 and 10000" << std::endl;
+        exit(-1);
+    }
+
+    nPoints = instance.nPoints;
+    xPoints = instance.xPoints;
+    yPoints = instance.yPoints;
+    matrix = instance.matrix;
+    metricType = instance.metric;
+    setSmallMatrix();
 }
 
-unsigned long TravellingSalesman::getNumberOfGenerations() const {
-    return generations;
+void TravellingSalesman::setSmallMatrix() {
+    smallMatrixSize = getSmallMatrixSize(nPoints);
+    if (smallMatrixSize == 0) {
+        smallMatrix.clear();
+        return;
+    }
+
+    /// fill the rows and columns of the points, the padding is never read
+    smallMatrix.assign(smallMatrixSize * smallMatrixSize, 0.0);
+    ::withMetric(metricType, xPoints, yPoints, matrix, nPoints, [this](const auto &metric) {
+        smallMatrixSymmetric = std::remove_reference_t<decltype(metric)>::symmetric;
+        for (unsigned long a = 0; a < nPoints; a++) {
+            for (unsigned long b = 0; b < nPoints; b++) {
+                smallMatrix[a * smallMatrixSize + b] = metric(a, b);
+            }
+        }
+    });
 }
 
-void TravellingSalesman::randomizeRoutePoints() {
-    if (mpiController->getID() == 0) {
-        for (unsigned long i = 0; i < nPoints; i++) {
-            xPoints[i] = Random::random(0, xSize);
-            yPoints[i] = Random::random(0, ySize);
+template<class Function>
+void TravellingSalesman::withMetric(Function &&function) const {
+    if (smallMatrixSize > 0) {
+        if (smallMatrixSymmetric) {
+            withSmallMatrixMetric<true>(smallMatrixSize, smallMatrix.data(), std::forward<Function>(function));
+        } else {
+            withSmallMatrixMetric<false>(smallMatrixSize, smallMatrix.data(), std::forward<Function>(function));
         }
+        return;
+    }
+    ::withMetric(metricType, xPoints, yPoints, matrix, nPoints, std::forward<Function>(function));
+}
+
+void TravellingSalesman::setBestPathCallback(BestPathCallback bestPathCallback_) {
+    bestPathCallback = std::move(bestPathCallback_);
+}
+
+void TravellingSalesman::setMetricsCallback(MetricsCallback metricsCallback_) {
+    metricsCallback = std::move(metricsCallback_);
+}
+
+void TravellingSalesman::setLowerBound(double lowerBound_) {
+    lowerBound = lowerBound_;
 
-        mpiController->printPointsToFile(populationSize, generations, xSize, ySize, xPoints, yPoints);
+    /// without a bound the target gap can never be reached, so the run needs another criterion to stop
+    if (generations == 0 && lowerBound <= 0.0 && timeBudget <= 0.0 && targetLength <= 0.0 &&
+        stagnationGenerations == 0) {
+        std::cerr << "gens = 0 with only a target gap requires a lower bound, which is not available for this instance "
+                     "(asymmetric metrics have no bound)" << std::endl;
+        exit(-1);
     }
+}
 
-    mpiController->pointsBroadcast(xPoints, yPoints);
+unsigned long TravellingSalesman::getNumberOfGenerations() const {
+    return generations;
 }
 
-void TravellingSalesman::loadRoutePoints(const std::string &fileName) {
-    if (mpiController->getID() == 0) {
-        /// open file, dump file content to a string and close file
-        std::ifstream file;
-        file.open(fileName);
+double TravellingSalesman::getBestRouteLength() const {
+    return bestRouteLength;
+}
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        file.close();
+const std::vector<unsigned long> &TravellingSalesman::getBestOrder() const {
+    return bestOrder;
+}
 
-        std::string inputStr = buffer.str();
-        char** ptr = nullptr;
-        size_t pos = 0;
-        for (unsigned long i = 0; i < nPoints; i++) {
-            /// find position of comma and endLine
-            size_t commaPos = inputStr.find(',');
-            size_t endLinePos = inputStr.find('\n');
+bool TravellingSalesman::isFinished(unsigned long generation) {
+    /// the generation limit is the same on all processes, but an outstanding reduction still has to complete
+    if (generations > 0 && generation >= generations) {
+        mpiController->stopFlagsReduceFinish();
+        return true;
+    }
 
-            /// xPoint is between startLine (pos) and comma and yPoint is between comma and endLine
-            auto xstr = inputStr.substr(pos, commaPos);
-            auto ystr = inputStr.substr(commaPos + 1, endLinePos);
-            inputStr = inputStr.substr(endLinePos + 1, inputStr.size() - 1);
+    /// a route within the target gap of the lower bound is as good as reaching the target length
+    double target = targetLength;
+    if (targetGap > 0.0 && lowerBound > 0.0) {
+        target = std::max(target, (1.0 + targetGap) * lowerBound);
+    }
 
-            /// set xPoint and yPoint
-            xPoints[i] = strtod(xstr.c_str(), ptr);
-            yPoints[i] = strtod(ystr.c_str(), ptr);
-        }
+    if (timeBudget <= 0.0 && target <= 0.0 && stagnationGenerations == 0) {
+        return false;
+    }
 
-        mpiController->printPointsToFile(populationSize, generations, xSize, ySize, xPoints, yPoints);
+    /// complete the reduction started in the previous generation
+    if (mpiController->stopFlagsReduceFinish()) {
+        return true;
     }
 
-    mpiController->pointsBroadcast(xPoints, yPoints);
+    /// evaluate the local criteria and start the reduction for the next generation
+    bool stop = (timeBudget > 0.0 && MPI_Wtime() - startTime >= timeBudget) ||
+                (target > 0.0 && bestRouteLength <= target);
+    bool improving = stagnationGenerations == 0 || generation - lastImprovement < stagnationGenerations;
+    mpiController->stopFlagsReduceStart(stop, improving);
+
+    return false;
 }
 
 void TravellingSalesman::createPopulation() {
-    /// initialize a number of parent routes equal to the pop size and set a random route
-    tspChildren = std::vector<TSPRoute*>(populationSize);
-    tspParents = std::vector<TSPRoute*>(populationSize);
+    withMetric([this](const auto &metric) { createPopulation(metric); });
+}
 
+template<class Metric>
+void TravellingSalesman::createPopulation(const Metric &metric) {
+    mpiController->setMigrationSize(nPoints, nMigrate);
+
+    /// free routes of a previous run with a different population size
+    if (tspParents.size() != populationSize) {
+        for (auto &route : tspParents) delete route;
+        tspParents = std::vector<TSPRoute*>(populationSize, nullptr);
+    }
+
+    /// initialize a number of parent routes equal to the pop size and set a random route
     for (unsigned long i = 0; i < populationSize; i++) {
-        tspChildren[i] = new TSPRoute(nPoints, xPoints, yPoints);
-        tspParents[i] = new TSPRoute(nPoints, xPoints, yPoints);
-        tspParents[i]->setRandomOrder();
+        if (tspParents[i] == nullptr) {
+            tspParents[i] = new TSPRoute(nPoints, Metric::symmetric);
+        } else {
+            tspParents[i]->setRouteSize(nPoints, Metric::symmetric);
+        }
+        tspParents[i]->setRandomOrder(metric);
     }
+
+    /// steady state mode only needs nOffspring children
+    for (auto &route : tspChildren) route->setRouteSize(nPoints, Metric::symmetric);
+    setNumberOfChildren(steadyState ? nOffspring : populationSize, Metric::symmetric);
+
+    /// allocate the orders of the children by the process that breeds them, so their pages are on its NUMA node
+    for (unsigned long i = 0; i < tspChildren.size(); i++) tspChildren[i]->setOrder(tspParents[i % populationSize]);
+
+    if (steadyState) setWorstHeap();
+    /// the costs of the mutation operators are measured on a child, which is overwritten when it is bred
+    MutationCostArray mutationCosts = tspChildren[0]->getMutationCosts(metric);
+    mutations.assign(steadyState ? 1 : nIslands, Mutation(adaptiveMutation, mutationCosts));
+    nBred = 0;
+    breedTime = 0.0;
+
+    /// reset the termination state for a new run
+    startTime = MPI_Wtime();
+    bestRouteLength = std::numeric_limits<double>::max();
+    lastImprovement = 0;
+    bestOrder.resize(nPoints);
+    globalBestOrder.resize(nPoints);
+
+    metricsGeneration = 0;
+    metricsTime = startTime;
+    generationsPerSecond = 0.0;
+    migrationWaitTime = 0.0;
 }
 
-int TravellingSalesman::getRandomWeightedIndex(double powerFactor) {
-    double power = std::pow(populationSize, powerFactor);
+int TravellingSalesman::getRandomWeightedIndex(double powerFactor, unsigned long size) {
+    double power = std::pow(size, powerFactor);
     double num = Random::random(0.0, power - 1.0);
     return (int) std::pow(num, 1.0 / powerFactor);
 }
 
-void TravellingSalesman::runGeneration(unsigned long generation) {
+void TravellingSalesman::setNumberOfChildren(unsigned long nChildren, bool symmetric) {
+    for (unsigned long i = nChildren; i < tspChildren.size(); i++) {
+        delete tspChildren[i];
+    }
+
+    unsigned long nOldChildren = tspChildren.size();
+    tspChildren.resize(nChildren);
+    for (unsigned long i = nOldChildren; i < nChildren; i++) {
+        tspChildren[i] = new TSPRoute(nPoints, symmetric);
+    }
+}
+
+std::vector<unsigned long> TravellingSalesman::getBalancedSizes(const std::vector<double> &throughputs,
+                                                                unsigned long total, unsigned long minSize) {
+    unsigned long nTasks = throughputs.size();
+    double throughputSum = 0.0;
+    for (auto &throughput : throughputs) throughputSum += throughput;
+
+    /// without measurements, divide equally
+    std::vector<double> shares(nTasks, 1.0 / (double) nTasks);
+    if (throughputSum > 0.0) {
+        for (unsigned long i = 0; i < nTasks; i++) shares[i] = throughputs[i] / throughputSum;
+    }
+
+    /// give every process the minimum size and divide the rest by the largest remainder method
+    std::vector<unsigned long> sizes(nTasks, minSize);
+    unsigned long rest = total - minSize * nTasks;
+    unsigned long assigned = 0;
+    std::vector<double> remainders(nTasks);
+    for (unsigned long i = 0; i < nTasks; i++) {
+        double exact = shares[i] * (double) rest;
+        auto whole = (unsigned long) exact;
+        sizes[i] += whole;
+        assigned += whole;
+        remainders[i] = exact - (double) whole;
+    }
 
-    /// sort the parents by route length (greatest length first, putting the 'fittest' member last)
-    std::sort(tspParents.begin(), tspParents.end(), [](TSPRoute* parent1, TSPRoute* parent2) {
-        return parent1->getRouteLength() > parent2->getRouteLength();
+    std::vector<unsigned long> index(nTasks);
+    std::iota(index.begin(), index.end(), 0);
+    std::stable_sort(index.begin(), index.end(), [&remainders](unsigned long a, unsigned long b) {
+        return remainders[a] > remainders[b];
     });
+    for (unsigned long i = 0; assigned < rest; i++, assigned++) {
+        sizes[index[i % nTasks]]++;
+    }
 
-    /// migrate every generationsBetweenMigrate and sort again
-    if (generation % generationsBetweenMigrate == 0) {
-        migrate();
+    return sizes;
+}
+
+template<class Metric>
+void TravellingSalesman::balance(const Metric &metric) {
+    int id = mpiController->getID();
+    auto nTasks = (unsigned long) mpiController->getNTasks();
+
+    /// gather the throughput and size of every process
+    double throughput = breedTime > 0.0 ? (double) nBred / breedTime : 0.0;
+    std::vector<double> allThroughputs(nTasks);
+    std::vector<unsigned long> allSizes(nTasks);
+    mpiController->allgatherThroughput(throughput, steadyState ? nOffspring : populationSize,
+                                       allThroughputs.data(), allSizes.data());
+    nBred = 0;
+    breedTime = 0.0;
+
+    unsigned long total = 0;
+    for (auto &size : allSizes) total += size;
+    unsigned long minSize = steadyState ? 1 : 2 * nMigrate + nKeepBestParents + 2;
+    if (nIslands > 1) minSize = std::max(minSize, (2 * nIslandMigrate + nKeepBestParents + 2) * nIslands);
+    auto sizes = getBalancedSizes(allThroughputs, total, std::min(minSize, total / nTasks));
+
+    if (steadyState) {
+        nOffspring = sizes[id];
+        setNumberOfChildren(nOffspring, Metric::symmetric);
+        return;
+    }
+
+    /// match processes with a surplus to processes with a deficit, the same on every process
+    struct Transfer {
+        int from, to;
+        unsigned long amount;
+    };
+    std::vector<Transfer> transfers;
+    unsigned long to = 0;
+    for (unsigned long from = 0; from < nTasks; from++) {
+        while (allSizes[from] > sizes[from]) {
+            while (allSizes[to] >= sizes[to]) to++;
+            unsigned long amount = std::min(allSizes[from] - sizes[from], sizes[to] - allSizes[to]);
+            transfers.push_back({(int) from, (int) to, amount});
+            allSizes[from] -= amount;
+            allSizes[to] += amount;
+        }
+    }
+
+    /// the parents to send are taken from the start of the islands in turn, so the kept best parents at the end of
+    /// every island stay and the islands shrink evenly
+    unsigned long nToSend = 0;
+    for (auto &transfer : transfers) {
+        if (transfer.from == id) nToSend += transfer.amount;
+    }
+    std::vector<unsigned long> sendIndices;
+    sendIndices.reserve(nToSend);
+    for (unsigned long i = 0; sendIndices.size() < nToSend; i++) {
+        for (unsigned long island = 0; island < nIslands && sendIndices.size() < nToSend; island++) {
+            unsigned long index = getIslandBegin(island) + i;
+            if (index + nKeepBestParents < getIslandBegin(island + 1)) sendIndices.push_back(index);
+        }
+    }
+
+    /// send the selected parents and receive new parents at the end
+    unsigned long nSent = 0;
+    std::vector<std::vector<unsigned long>> sendData;
+    std::vector<MPI_Request> requests;
+    sendData.reserve(transfers.size());
+    requests.reserve(transfers.size());
+    for (auto &transfer : transfers) {
+        if (transfer.from != id) continue;
+
+        sendData.emplace_back(transfer.amount * nPoints);
+        for (unsigned long i = 0; i < transfer.amount; i++, nSent++) {
+            const auto &order = tspParents[sendIndices[nSent]]->getOrder();
+            std::copy(order.begin(), order.end(), &sendData.back()[i * nPoints]);
+        }
+        requests.emplace_back();
+        mpiController->ordersSend(sendData.back().data(), transfer.amount, transfer.to, &requests.back());
+    }
+
+    std::vector<unsigned long> receiveData;
+    std::vector<unsigned long> order(nPoints);
+    for (auto &transfer : transfers) {
+        if (transfer.to != id) continue;
+
+        receiveData.resize(transfer.amount * nPoints);
+        mpiController->ordersReceive(receiveData.data(), transfer.amount, transfer.from);
+        for (unsigned long i = 0; i < transfer.amount; i++) {
+            std::copy(&receiveData[i * nPoints], &receiveData[(i + 1) * nPoints], order.begin());
+            tspParents.push_back(new TSPRoute(nPoints, Metric::symmetric));
+            tspParents.back()->setOrder(order, metric);
+        }
+    }
+
+    MPI_Waitall((int) requests.size(), requests.data(), MPI_STATUSES_IGNORE);
 
-        std::sort(tspParents.begin(), tspParents.end(), [](TSPRoute* parent1, TSPRoute* parent2) {
+    /// remove the parents that were sent
+    for (auto &index : sendIndices) {
+        delete tspParents[index];
+        tspParents[index] = nullptr;
+    }
+    tspParents.erase(std::remove(tspParents.begin(), tspParents.end(), nullptr), tspParents.end());
+
+    populationSize = tspParents.size();
+    setNumberOfChildren(populationSize, Metric::symmetric);
+}
+
+unsigned long TravellingSalesman::getIslandBegin(unsigned long island) const {
+    return island * populationSize / nIslands;
+}
+
+void TravellingSalesman::sortIslands() {
+    for (unsigned long island = 0; island < nIslands; island++) {
+        auto begin = tspParents.begin() + (long) getIslandBegin(island);
+        auto end = tspParents.begin() + (long) getIslandBegin(island + 1);
+        std::sort(begin, end, [](TSPRoute* parent1, TSPRoute* parent2) {
             return parent1->getRouteLength() > parent2->getRouteLength();
         });
     }
+}
+
+void TravellingSalesman::migrateIslands() {
+    /// the i-th best parents of all islands form a ring, the best nIslandMigrate move one island right and the next
+    /// nIslandMigrate one island left, so the routes are never copied
+    std::vector<TSPRoute*> ring(nIslands);
+    for (unsigned long i = 0; i < 2 * nIslandMigrate; i++) {
+        for (unsigned long island = 0; island < nIslands; island++) {
+            ring[island] = tspParents[getIslandBegin(island + 1) - 1 - i];
+        }
+        if (i < nIslandMigrate) {
+            std::rotate(ring.begin(), ring.end() - 1, ring.end());
+        } else {
+            std::rotate(ring.begin(), ring.begin() + 1, ring.end());
+        }
+        for (unsigned long island = 0; island < nIslands; island++) {
+            tspParents[getIslandBegin(island + 1) - 1 - i] = ring[island];
+        }
+    }
+}
+
+unsigned long TravellingSalesman::getTournamentIndex(unsigned long tournamentSize) {
+    auto best = (unsigned long) Random::randInt(0, (int) populationSize - 1);
+    for (unsigned long i = 1; i < tournamentSize; i++) {
+        auto other = (unsigned long) Random::randInt(0, (int) populationSize - 1);
+        if (tspParents[other]->getRouteLength() < tspParents[best]->getRouteLength()) best = other;
+    }
+    return best;
+}
+
+void TravellingSalesman::setWorstHeap() {
+    worstHeap.resize(populationSize);
+    bestIndex = 0;
+    for (unsigned long i = 0; i < populationSize; i++) {
+        worstHeap[i] = i;
+        if (tspParents[i]->getRouteLength() < tspParents[bestIndex]->getRouteLength()) bestIndex = i;
+    }
+
+    std::make_heap(worstHeap.begin(), worstHeap.end(), [this](unsigned long a, unsigned long b) {
+        return tspParents[a]->getRouteLength() < tspParents[b]->getRouteLength();
+    });
+}
+
+bool TravellingSalesman::replaceWorst(TSPRoute* &route) {
+    auto longerFirst = [this](unsigned long a, unsigned long b) {
+        return tspParents[a]->getRouteLength() < tspParents[b]->getRouteLength();
+    };
+
+    unsigned long worst = worstHeap.front();
+    if (route->getRouteLength() >= tspParents[worst]->getRouteLength()) return false;
+
+    /// swap the pointers, the worst parent becomes the scratch route, and restore the heap
+    std::pop_heap(worstHeap.begin(), worstHeap.end(), longerFirst);
+    std::swap(tspParents[worst], route);
+    std::push_heap(worstHeap.begin(), worstHeap.end(), longerFirst);
+
+    if (tspParents[worst]->getRouteLength() < tspParents[bestIndex]->getRouteLength()) bestIndex = worst;
+    return true;
+}
+
+void TravellingSalesman::setBestRoute(unsigned long generation, const TSPRoute* route) {
+    /// keep track of the best path
+    double routeLength = route->getRouteLength();
+    if (routeLength < bestRouteLength) {
+        bestRouteLength = routeLength;
+        lastImprovement = generation;
+        bestOrder = route->getOrder();
+    }
+
+    /// pass the global best path to the callback on the root process
+    if (cout > 0) {
+        double globalBestRouteLength = routeLength;
+        const auto &order = route->getOrder();
+        std::copy(order.begin(), order.end(), globalBestOrder.begin());
+        if (mpiController->gatherBestPath(globalBestRouteLength, globalBestOrder.data()) && bestPathCallback) {
+            bestPathCallback(generation, globalBestRouteLength, globalBestOrder);
+        }
+    }
+}
+
+void TravellingSalesman::runGeneration(unsigned long generation) {
+    withMetric([this, generation](const auto &metric) {
+        if (steadyState) {
+            runSteadyStateGeneration(generation, metric);
+        } else {
+            runGeneration(generation, metric);
+        }
+    });
+}
+
+template<class Metric>
+void TravellingSalesman::runGeneration(unsigned long generation, const Metric &metric) {
+
+    /// balance the populations by the throughput measured since the last balancing round
+    if (balancePopulation && generation > 0 && generation % generationsBetweenBalance == 0) {
+        balance(metric);
+    }
 
-    /// print best path to file, which is at the last index of tspParents
-    double bestRouteLength = tspParents[populationSize - 1]->getRouteLength();
-    auto bestOrder = tspParents[populationSize - 1]->getOrder();
-    auto* bestOrderArr = new unsigned long[nPoints];
-    std::copy(bestOrder.begin(), bestOrder.end(), &bestOrderArr[0]);
-    mpiController->printBestPathToFile(generation, bestRouteLength, bestOrderArr);
+    /// sort the parents of every island by route length (greatest length first, putting the 'fittest' member last)
+    sortIslands();
 
-    /// create new children equal to the population size, keep the 5 best parents intact
-    for (unsigned long i = 0; i < populationSize - nKeepBestParents; i++) {
-        // select two unique parents randomly
-        // the likelihood of a parent selected is proportional to the power (powerFactor) of its index in the array
-        double powerFactor = 2;
-        int r1 = getRandomWeightedIndex(powerFactor);
-        int r2 = getRandomWeightedIndex(powerFactor);
-        while (r2 == r1) r2 = getRandomWeightedIndex(powerFactor);
+    /// migrate between processes every generationsBetweenMigrate and sort again
+    if (generation % generationsBetweenMigrate == 0) {
+        migrate(metric);
+        sortIslands();
+    }
+
+    /// migrate between the islands of this process every generationsBetweenIslandMigrate and sort again
+    if (nIslands > 1 && generation % generationsBetweenIslandMigrate == 0) {
+        migrateIslands();
+        sortIslands();
+    }
 
-        tspChildren[i]->setOrderFromParents(tspParents[r1], tspParents[r2]);
+    /// keep track of the best path, which is at the last index of one of the islands
+    unsigned long best = populationSize - 1;
+    for (unsigned long island = 1; island < nIslands; island++) {
+        unsigned long last = getIslandBegin(island) - 1;
+        if (tspParents[last]->getRouteLength() < tspParents[best]->getRouteLength()) best = last;
     }
+    setBestRoute(generation, tspParents[best]);
+
+    /// create new children from parents of the same island, keep the best parents of every island intact
+    double breedStartTime = MPI_Wtime();
+    for (unsigned long island = 0; island < nIslands; island++) {
+        unsigned long begin = getIslandBegin(island);
+        unsigned long size = getIslandBegin(island + 1) - begin;
+        for (unsigned long i = begin; i < begin + size - nKeepBestParents; i++) {
+            // select two unique parents randomly
+            // the likelihood of a parent selected is proportional to the power (powerFactor) of its index in the island
+            double powerFactor = 2;
+            int r1 = getRandomWeightedIndex(powerFactor, size);
+            int r2 = getRandomWeightedIndex(powerFactor, size);
+            while (r2 == r1) r2 = getRandomWeightedIndex(powerFactor, size);
+
+            tspChildren[i]->setOrderFromParents(tspParents[begin + r1], tspParents[begin + r2], mutations[island],
+                                                metric);
+        }
+    }
+    breedTime += MPI_Wtime() - breedStartTime;
+    nBred += populationSize - nIslands * nKeepBestParents;
 
     /// set the children as the new parents
-    for (unsigned long i = 0; i < populationSize - nKeepBestParents; i++) {
-        tspParents[i]->setOrder(tspChildren[i]->getOrder());
+    for (unsigned long island = 0; island < nIslands; island++) {
+        for (unsigned long i = getIslandBegin(island); i < getIslandBegin(island + 1) - nKeepBestParents; i++) {
+            tspParents[i]->setOrder(tspChildren[i]);
+        }
+    }
+}
+
+template<class Metric>
+void TravellingSalesman::runSteadyStateGeneration(unsigned long generation, const Metric &metric) {
+    const unsigned long tournamentSize = 3;
+
+    /// balance the number of offspring by the throughput measured since the last balancing round
+    if (balancePopulation && generation > 0 && generation % generationsBetweenBalance == 0) {
+        balance(metric);
+    }
+
+    /// migrate every generationsBetweenMigrate
+    if (generation % generationsBetweenMigrate == 0) {
+        migrate(metric);
+    }
+
+    /// create offspring from parents selected by tournament and let them replace the worst parents
+    double breedStartTime = MPI_Wtime();
+    for (unsigned long i = 0; i < nOffspring; i++) {
+        unsigned long r1 = getTournamentIndex(tournamentSize);
+        unsigned long r2 = getTournamentIndex(tournamentSize);
+        while (r2 == r1) r2 = getTournamentIndex(tournamentSize);
+
+        tspChildren[i]->setOrderFromParents(tspParents[r1], tspParents[r2], mutations[0], metric);
+
+        /// a child with the length of a parent is most likely a copy, which would only reduce diversity
+        double routeLength = tspChildren[i]->getRouteLength();
+        if (routeLength == tspParents[r1]->getRouteLength() || routeLength == tspParents[r2]->getRouteLength()) {
+            continue;
+        }
+        replaceWorst(tspChildren[i]);
     }
+    breedTime += MPI_Wtime() - breedStartTime;
+    nBred += nOffspring;
+
+    setBestRoute(generation, tspParents[bestIndex]);
 }
 
-void TravellingSalesman::migrate() {
+template<class Metric>
+void TravellingSalesman::migrate(const Metric &metric) {
 
     unsigned long nMigrate = mpiController->getNMigrate();
 
     auto* receiveMigrationData = new unsigned long[nMigrate * nPoints * 2];
     auto* sendMigrationData = new unsigned long[nMigrate * nPoints * 2];
 
+    /// the emigrants are the best parents: the last ones of the sorted parents, or in steady state mode and with
+    /// multiple islands the first ones of a partially sorted index
+    std::vector<unsigned long> emigrants(nMigrate * 2);
+    if (steadyState || nIslands > 1) {
+        std::vector<unsigned long> index(populationSize);
+        std::iota(index.begin(), index.end(), 0);
+        std::partial_sort(index.begin(), index.begin() + (long) (nMigrate * 2), index.end(),
+                          [this](unsigned long a, unsigned long b) {
+                              return tspParents[a]->getRouteLength() < tspParents[b]->getRouteLength();
+                          });
+        std::copy(index.begin(), index.begin() + (long) (nMigrate * 2), emigrants.begin());
+    } else {
+        for (unsigned long i = 0; i < nMigrate * 2; i++) {
+            emigrants[i] = populationSize - 1 - i;
+        }
+    }
+
     /// put all outgoing parents' orders into one array
     for (unsigned long i = 0; i < nMigrate * 2; i++) {
-        auto order = tspParents[populationSize - 1 - i]->getOrder();
+        const auto &order = tspParents[emigrants[i]]->getOrder();
         std::copy(order.begin(), order.end(), &sendMigrationData[i * nPoints]);
     }
 
-    /// send and receive migrating populations to other processes
+    /// send and receive migrating populations to other processes, measuring the time spent waiting
+    double waitStartTime = MPI_Wtime();
     mpiController->orderBufferSend(&sendMigrationData[0], Neighbour::left);
     mpiController->orderBufferSend(&sendMigrationData[nPoints * nMigrate], Neighbour::right);
 
@@ -189,14 +651,72 @@ void TravellingSalesman::migrate() {
     mpiController->orderBufferReceive(&receiveMigrationData[0], Neighbour::left);
 
     mpiController->sendBufferedMessages();
+    migrationWaitTime += MPI_Wtime() - waitStartTime;
 
     /// separate the array of incoming route orders and put them into the place of parents that migrated
+    std::vector<unsigned long> order(nPoints);
     for (unsigned long i = 0; i < nMigrate * 2; i++) {
-        std::vector<unsigned long> order;
-        std::copy(&receiveMigrationData[i * nPoints], &receiveMigrationData[(i + 1) * nPoints], back_inserter(order));
-        tspParents[populationSize - 1 - i]->setOrder(order);
+        std::copy(&receiveMigrationData[i * nPoints], &receiveMigrationData[(i + 1) * nPoints], order.begin());
+        if (steadyState) {
+            tspChildren[0]->setOrder(order, metric);
+            replaceWorst(tspChildren[0]);
+        } else {
+            tspParents[emigrants[i]]->setOrder(order, metric);
+        }
     }
 
     delete[] receiveMigrationData;
     delete[] sendMigrationData;
 }
+
+void TravellingSalesman::reportMetrics(unsigned long generation) {
+    if (metricsInterval == 0 || generation % metricsInterval != 0) return;
+
+    /// report the metrics of the previous report before starting a new reduction
+    finishMetrics();
+
+    /// the rate of generations since the previous report
+    double time = MPI_Wtime();
+    if (generation > metricsGeneration) {
+        generationsPerSecond = (double) (generation - metricsGeneration) / (time - metricsTime);
+    }
+    metricsGeneration = generation;
+    metricsTime = time;
+
+    /// the mean route length and the fraction of distinct route lengths of the parents
+    std::vector<double> routeLengths(populationSize);
+    for (unsigned long i = 0; i < populationSize; i++) {
+        routeLengths[i] = tspParents[i]->getRouteLength();
+    }
+    double meanRouteLength = std::accumulate(routeLengths.begin(), routeLengths.end(), 0.0) / (double) populationSize;
+    std::sort(routeLengths.begin(), routeLengths.end());
+    auto nDistinct = std::unique(routeLengths.begin(), routeLengths.end()) - routeLengths.begin();
+    double diversity = (double) nDistinct / (double) populationSize;
+
+    /// the mutation statistics of all islands
+    MutationStatisticsArray mutationStatistics{};
+    for (auto &mutation : mutations) {
+        for (unsigned long i = 0; i < nMutationOperators; i++) {
+            mutationStatistics[i].nApplied += mutation.getStatistics()[i].nApplied;
+            mutationStatistics[i].nImproved += mutation.getStatistics()[i].nImproved;
+            mutationStatistics[i].improvement += mutation.getStatistics()[i].improvement;
+            mutationStatistics[i].time += mutation.getStatistics()[i].time;
+        }
+    }
+
+    mpiController->metricsReduceStart(bestRouteLength, meanRouteLength, diversity, migrationWaitTime,
+                                      mutationStatistics);
+}
+
+void TravellingSalesman::finishMetrics() {
+    TSPMetrics metrics;
+    if (!mpiController->metricsReduceFinish(metrics.bestRouteLength, metrics.meanRouteLength, metrics.diversity,
+                                            metrics.migrationWaitTime, metrics.mutationStatistics)) {
+        return;
+    }
+
+    metrics.generation = metricsGeneration;
+    metrics.nTasks = mpiController->getNTasks();
+    metrics.generationsPerSecond = generationsPerSecond;
+    if (metricsCallback) metricsCallback(metrics);
+}
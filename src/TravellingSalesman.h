@@ -8,57 +8,268 @@
 
 #include <iostream>
 #include <vector>
+#include <functional>
+
+#include "TSPParameters.h"
+#include "DistanceMetric.h"
+#include "Mutation.h"
 
 class MPIController;
 
+struct TSPInstance;
+
 class TSPRoute;
 
+/**
+ * @brief called on the root process with the global best path of a generation
+ */
+using BestPathCallback = std::function<void(unsigned long generation, double routeLength,
+                                            const std::vector<unsigned long> &order)>;
+
+/**
+ * @brief metrics of a run, aggregated over all processes on the root process
+ */
+struct TSPMetrics {
+    unsigned long generation = 0;
+    int nTasks = 0;
+    double bestRouteLength = 0.0;
+    double meanRouteLength = 0.0;
+    double generationsPerSecond = 0.0;
+
+    /// mean time per process spent waiting for immigrants since the start of the run, in seconds
+    double migrationWaitTime = 0.0;
+
+    /// mean fraction of distinct route lengths in the populations, a cheap measure of their diversity
+    double diversity = 0.0;
+
+    /// totals of the mutation operators over all processes and islands since the start of the run
+    MutationStatisticsArray mutationStatistics{};
+};
+
+/**
+ * @brief called on the root process with the metrics of a generation
+ */
+using MetricsCallback = std::function<void(const TSPMetrics &metrics)>;
+
 class TravellingSalesman {
 private:
     std::vector<TSPRoute*> tspChildren;
     std::vector<TSPRoute*> tspParents;
 
+    /// steady state mode: tspChildren holds nOffspring routes, the parents are indexed by a max-heap on route length
+    bool steadyState = false;
+    unsigned long nOffspring = 0;
+    std::vector<unsigned long> worstHeap;
+    unsigned long bestIndex = 0;
+
+    /// hierarchical islands: the parents are divided into nIslands contiguous islands, which are sorted separately
+    unsigned long nIslands = 1;
+    unsigned long nIslandMigrate = 0;
+    unsigned long generationsBetweenIslandMigrate = 1;
+
+    /// mutation operator selector of every island (of the whole population in steady state mode)
+    bool adaptiveMutation = true;
+    std::vector<Mutation> mutations;
+
+    /// balancing mode: number of children bred and the time spent on it since the last balancing round
+    bool balancePopulation = false;
+    unsigned long generationsBetweenBalance = 0;
+    unsigned long nBred = 0;
+    double breedTime = 0.0;
+
+    /// metrics reported every metricsInterval generations, each reduction is completed in the next report
+    unsigned long metricsInterval = 0;
+    unsigned long metricsGeneration = 0;
+    double metricsTime = 0.0;
+    double generationsPerSecond = 0.0;
+    double migrationWaitTime = 0.0;
+
     MPIController* mpiController;
+    BestPathCallback bestPathCallback;
+    MetricsCallback metricsCallback;
+
+    unsigned long populationSize = 0;
+    unsigned long generations = 0;
+    unsigned long nKeepBestParents = 0;
+    unsigned long generationsBetweenMigrate = 1;
+    unsigned long nMigrate = 0;
+    unsigned long cout = 0;
+
+    unsigned long nPoints = 0;
+    const double* xPoints = nullptr;
+    const double* yPoints = nullptr;
+    const double* matrix = nullptr;
+    MetricType metricType = MetricType::euclidean;
+
+    /// instances of at most 256 points use a precomputed smallMatrixSize x smallMatrixSize distance matrix
+    unsigned long smallMatrixSize = 0;
+    bool smallMatrixSymmetric = true;
+    std::vector<double> smallMatrix;
+
+    double timeBudget = 0.0;
+    double targetLength = 0.0;
+    double targetGap = 0.0;
+    double lowerBound = 0.0;
+    unsigned long stagnationGenerations = 0;
 
-    unsigned long populationSize;
-    unsigned long generations;
-    unsigned long nKeepBestParents;
-    unsigned long generationsBetweenMigrate;
-    double xSize;
-    double ySize;
+    double startTime = 0.0;
+    double bestRouteLength = 0.0;
+    unsigned long lastImprovement = 0;
+    std::vector<unsigned long> bestOrder;
+    std::vector<unsigned long> globalBestOrder;
 
-    unsigned long nPoints;
-    double* xPoints;
-    double* yPoints;
+    /**
+     * @brief return a random parent index weighted by powerFactor according to the position of the parent in an
+     * island of size parents
+     */
+    static int getRandomWeightedIndex(double powerFactor, unsigned long size);
+
+    /**
+     * @brief return the index of the first parent of the island, island nIslands gives the population size
+     */
+    [[nodiscard]] unsigned long getIslandBegin(unsigned long island) const;
 
     /**
-     * @brief return a random parent index weighted by powerFactor according to the position of the parent in the array
+     * @brief sort the parents of every island by route length (greatest length first, putting the 'fittest' last)
      */
-    int getRandomWeightedIndex(double powerFactor);
+    void sortIslands();
+
+    /**
+     * @brief migrate the best parents of every sorted island to the neighbouring islands by rotating the pointers
+     */
+    void migrateIslands();
+
+    /**
+     * @brief return the index of the shortest of tournamentSize randomly selected parents
+     */
+    unsigned long getTournamentIndex(unsigned long tournamentSize);
+
+    /**
+     * @brief build the max-heap of parent indices with the longest route on top
+     */
+    void setWorstHeap();
+
+    /**
+     * @brief swap the route with the worst parent if it is shorter, keeping the heap and best index up to date
+     */
+    bool replaceWorst(TSPRoute* &route);
+
+    /**
+     * @brief keep track of the best route and pass the global best route to the callback
+     */
+    void setBestRoute(unsigned long generation, const TSPRoute* route);
+
+    /**
+     * @brief divide total between processes proportional to their throughput, giving every process at least minSize
+     */
+    static std::vector<unsigned long> getBalancedSizes(const std::vector<double> &throughputs,
+                                                       unsigned long total, unsigned long minSize);
+
+    /**
+     * @brief resize the children to nChildren routes, reusing the existing routes
+     */
+    void setNumberOfChildren(unsigned long nChildren, bool symmetric);
+
+    /**
+     * @brief balance the populations between processes by their throughput (children bred per second)
+     *
+     * Processes with a too large population send some of their parents to processes with a too small one, taken from
+     * the start of every island in turn, so the kept best parents at the end of every island are never sent. In steady
+     * state mode the number of offspring per generation is balanced instead, which needs no communication of routes.
+     */
+    template<class Metric>
+    void balance(const Metric &metric);
+
+    /**
+     * @brief call function with the distance metric of the instance, so every metric gets its own instantiation
+     *
+     * Small instances get the SmallMatrixMetric of the smallest size that fits them instead.
+     */
+    template<class Function>
+    void withMetric(Function &&function) const;
+
+    /**
+     * @brief precompute the distances of an instance with at most 256 points, or clear them for larger instances
+     */
+    void setSmallMatrix();
+
+    template<class Metric>
+    void createPopulation(const Metric &metric);
+
+    template<class Metric>
+    void runGeneration(unsigned long generation, const Metric &metric);
+
+    template<class Metric>
+    void runSteadyStateGeneration(unsigned long generation, const Metric &metric);
 
     /**
      * @brief migrate some of the best parents between processes using the stepping-stone model
+     *
+     * The emigrants are replaced by the immigrants, or in steady state mode the immigrants replace the worst parents.
+     * With multiple islands the emigrants are the best parents of all islands of the process.
      */
-    void migrate();
+    template<class Metric>
+    void migrate(const Metric &metric);
 
 public:
-    TravellingSalesman(int argc, char** argv, MPIController* mpiController_,
-                       unsigned long nKeepBestParents_, unsigned long generationsBetweenMigrate_);
+    explicit TravellingSalesman(MPIController* mpiController_);
+
+    TravellingSalesman(const TravellingSalesman &) = delete;
+
+    TravellingSalesman &operator=(const TravellingSalesman &) = delete;
+
+    ~TravellingSalesman();
+
+    /**
+     * @brief set and check the parameters of the genetic algorithm, the population size is divided between processes
+     */
+    void setParameters(const TSPParameters &params);
+
+    /**
+     * @brief set the points to visit and their distance metric, which are not copied and have to stay valid during
+     * the run
+     */
+    void setInstance(const TSPInstance &instance);
+
+    /**
+     * @brief set the function called on the root process with the global best path if the parameter cout is non-zero
+     */
+    void setBestPathCallback(BestPathCallback bestPathCallback_);
+
+    /**
+     * @brief set the function called on the root process with the metrics if the parameter metricsInterval is non-zero
+     */
+    void setMetricsCallback(MetricsCallback metricsCallback_);
+
+    /**
+     * @brief set the lower bound on the route length, used for the target gap termination criterion
+     *
+     * Exits if the target gap is the only criterion to stop a run without generation limit and there is no bound
+     * (0.0, e.g. for an asymmetric instance), as the run would never finish.
+     */
+    void setLowerBound(double lowerBound_);
 
     [[nodiscard]] unsigned long getNumberOfGenerations() const;
 
+    [[nodiscard]] double getBestRouteLength() const;
+
     /**
-     * @brief load the route points from a file
+     * @brief return the shortest route found by this process since createPopulation
      */
-    void loadRoutePoints(const std::string &fileName);
+    [[nodiscard]] const std::vector<unsigned long> &getBestOrder() const;
 
     /**
-     * @brief create a set of x and y locations to visit randomly selected within the box x(0,xSize), y(0,ySize)
+     * @brief return true if the run should stop before the specified generation
+     *
+     * The termination flags of all processes are combined with a non-blocking reduction that is started in one
+     * generation and completed in the next, so all processes stop in the same generation without a barrier.
      */
-    void randomizeRoutePoints();
+    bool isFinished(unsigned long generation);
 
     /**
      * @brief initialize the parents and children TSPRoutes and set a random order for each parent
+     *
+     * Routes allocated for a previous instance with the same population size are reused.
      */
     void createPopulation();
 
@@ -70,9 +281,25 @@ public:
      *
      * 2. Set the children as the parents for the next generation and repeat.
      *
-     * 3. Sort parents by route length and print the best parent to file.
+     * 3. Sort parents by route length and pass the global best parent to the best path callback.
+     *
+     * In steady state mode, nOffspring children are created from parents selected by tournament, and every child
+     * that is shorter than the worst parent takes its place. The population is never sorted or copied.
      */
     void runGeneration(unsigned long generation);
+
+    /**
+     * @brief reduce the metrics of the generation to the root process every metricsInterval generations
+     *
+     * The reduction is non-blocking and completed in the next report, so the metrics passed to the callback are those
+     * of metricsInterval generations earlier. The last report of a run is completed with finishMetrics.
+     */
+    void reportMetrics(unsigned long generation);
+
+    /**
+     * @brief complete the outstanding metrics reduction and pass the result to the callback on the root process
+     */
+    void finishMetrics();
 };
 
 